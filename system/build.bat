@@ -35,12 +35,84 @@ if %ERRORLEVEL% NEQ 0 goto :error
 g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/UserInterface.cpp -o obj/UserInterface.o
 if %ERRORLEVEL% NEQ 0 goto :error
 
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/Simulator.cpp -o obj/Simulator.o
+if %ERRORLEVEL% NEQ 0 goto :error
+
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/EventRenderer.cpp -o obj/EventRenderer.o
+if %ERRORLEVEL% NEQ 0 goto :error
+
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/BatchProcessor.cpp -o obj/BatchProcessor.o
+if %ERRORLEVEL% NEQ 0 goto :error
+
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/Protocol.cpp -o obj/Protocol.o
+if %ERRORLEVEL% NEQ 0 goto :error
+
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/EventServer.cpp -o obj/EventServer.o
+if %ERRORLEVEL% NEQ 0 goto :error
+
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/LoadGenerator.cpp -o obj/LoadGenerator.o
+if %ERRORLEVEL% NEQ 0 goto :error
+
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/Recurrence.cpp -o obj/Recurrence.o
+if %ERRORLEVEL% NEQ 0 goto :error
+
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/Compression.cpp -o obj/Compression.o
+if %ERRORLEVEL% NEQ 0 goto :error
+
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/ArchiveStore.cpp -o obj/ArchiveStore.o
+if %ERRORLEVEL% NEQ 0 goto :error
+
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/Scheduler.cpp -o obj/Scheduler.o
+if %ERRORLEVEL% NEQ 0 goto :error
+
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/IntervalTree.cpp -o obj/IntervalTree.o
+if %ERRORLEVEL% NEQ 0 goto :error
+
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/ChangeFeed.cpp -o obj/ChangeFeed.o
+if %ERRORLEVEL% NEQ 0 goto :error
+
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/PersistentEventMap.cpp -o obj/PersistentEventMap.o
+if %ERRORLEVEL% NEQ 0 goto :error
+
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/UndoHistory.cpp -o obj/UndoHistory.o
+if %ERRORLEVEL% NEQ 0 goto :error
+
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/SnapshotWriter.cpp -o obj/SnapshotWriter.o
+if %ERRORLEVEL% NEQ 0 goto :error
+
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/BackupStore.cpp -o obj/BackupStore.o
+if %ERRORLEVEL% NEQ 0 goto :error
+
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/Parallel.cpp -o obj/Parallel.o
+if %ERRORLEVEL% NEQ 0 goto :error
+
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/Checksum.cpp -o obj/Checksum.o
+if %ERRORLEVEL% NEQ 0 goto :error
+
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/Interchange.cpp -o obj/Interchange.o
+if %ERRORLEVEL% NEQ 0 goto :error
+
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/Reports.cpp -o obj/Reports.o
+if %ERRORLEVEL% NEQ 0 goto :error
+
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/CalendarRegistry.cpp -o obj/CalendarRegistry.o
+if %ERRORLEVEL% NEQ 0 goto :error
+
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/TextStore.cpp -o obj/TextStore.o
+if %ERRORLEVEL% NEQ 0 goto :error
+
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/SharedJournal.cpp -o obj/SharedJournal.o
+if %ERRORLEVEL% NEQ 0 goto :error
+
+g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/FileSync.cpp -o obj/FileSync.o
+if %ERRORLEVEL% NEQ 0 goto :error
+
 g++ -std=c++17 -Wall -Wextra -O2 -Iinclude -c src/main.cpp -o obj/main.o
 if %ERRORLEVEL% NEQ 0 goto :error
 
 REM Link executable
 echo Linking executable...
-g++ obj/Event.o obj/EventManager.o obj/FileHandler.o obj/UserInterface.o obj/main.o -o bin/event_reminder_windows.exe -static-libgcc -static-libstdc++ -static
+g++ obj/Event.o obj/EventManager.o obj/FileHandler.o obj/UserInterface.o obj/Simulator.o obj/EventRenderer.o obj/BatchProcessor.o obj/Protocol.o obj/EventServer.o obj/LoadGenerator.o obj/Recurrence.o obj/Compression.o obj/ArchiveStore.o obj/Scheduler.o obj/IntervalTree.o obj/ChangeFeed.o obj/PersistentEventMap.o obj/UndoHistory.o obj/SnapshotWriter.o obj/BackupStore.o obj/Parallel.o obj/Checksum.o obj/Interchange.o obj/Reports.o obj/CalendarRegistry.o obj/TextStore.o obj/SharedJournal.o obj/FileSync.o obj/main.o -o bin/event_reminder_windows.exe -static-libgcc -static-libstdc++ -static
 if %ERRORLEVEL% NEQ 0 goto :error
 
 echo.
@@ -0,0 +1,68 @@
+#ifndef ARCHIVESTORE_H
+#define ARCHIVESTORE_H
+
+#include "EventManager.h"
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstdint>
+
+// Which events leave the working set
+struct ArchivePolicy {
+    bool archiveCompleted = true;
+    int maxAgeDays = 30; // Pending one-off events this far in the past; 0 = keep forever
+
+    bool shouldArchive(const Event& event, std::time_t now) const;
+};
+
+struct ArchiveStats {
+    size_t frames = 0;
+    size_t events = 0;
+    uint64_t rawBytes = 0;
+    uint64_t storedBytes = 0;
+};
+
+// Cold tier: an append-only file of compressed frames, one per archival run.
+// Each frame is [header][Compression payload of length-prefixed serialized
+// events]. Nothing is ever rewritten; the archive is read only on demand.
+class ArchiveStore {
+private:
+    struct FrameHeader {
+        char magic[4];
+        uint32_t recordCount;
+        uint32_t rawSize;
+        uint32_t storedSize;
+        int32_t maxId;
+        int64_t archivedAt;
+    };
+
+    std::string filename;
+    bool syncWrites;
+
+    // Calls visit for each frame header; payload is read only if wanted
+    bool scanFrames(const std::function<void(const FrameHeader&)>& header,
+                    const std::function<bool(const Event&)>& visit) const;
+
+public:
+    explicit ArchiveStore(const std::string& filename = "events.dat.archive");
+
+    static std::string forDataFile(const std::string& dataFile) { return dataFile + ".archive"; }
+    const std::string& getFilename() const { return filename; }
+    void setSyncWrites(bool enabled) { syncWrites = enabled; }
+
+    // A frame is on disk (unless sync is off) before this returns true
+    bool append(const std::vector<Event>& events, std::time_t archivedAt);
+
+    // Moves matching events from manager into a new frame; returns the count
+    size_t archive(EventManager& manager, const ArchivePolicy& policy);
+
+    // Queries decompress frame by frame; visit returns false to stop early
+    bool forEach(const std::function<bool(const Event&)>& visit) const;
+    std::vector<Event> searchByTitle(const std::string& title) const;
+    bool getStats(ArchiveStats& stats) const; // Header scan only
+
+    // Keeps new events from reusing archived IDs (header scan only)
+    void reserveIds() const;
+};
+
+#endif
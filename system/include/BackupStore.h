@@ -0,0 +1,74 @@
+#ifndef BACKUPSTORE_H
+#define BACKUPSTORE_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <ctime>
+#include <cstdint>
+
+// One backup of the data file: the chunks it is made of, in order
+struct BackupGeneration {
+    int id = 0;
+    std::time_t createdAt = 0;
+    uint64_t size = 0;     // Bytes in the data file at backup time
+    uint64_t newBytes = 0; // Bytes this generation added to the pack
+    std::vector<uint32_t> chunks; // Positions in the chunk index
+};
+
+// Deduplicating backup generations for a data file. The file is cut into
+// content-defined chunks (boundaries follow the bytes, not offsets, so an
+// edit only changes the chunks around it); each distinct chunk is stored
+// once in an append-only pack, and a generation is just its chunk list.
+//
+//   <data>.backup.pack   chunk bytes
+//   <data>.backup.index  [hash 16][offset 8][length 4] per chunk
+//   <data>.backup.log    one record per generation, written last
+//
+// The pack and index are synced before the log record is written, and the
+// log after it, so a generation reported as created survives a power loss.
+//
+// On Linux chunks move between files with copy_file_range, which stays in
+// the kernel and can share extents on filesystems that support reflinks.
+class BackupStore {
+private:
+    struct Chunk {
+        uint64_t hashLow;
+        uint64_t hashHigh;
+        uint64_t offset; // In the pack
+        uint32_t length;
+    };
+
+    std::string dataFile;
+    std::string packFile;
+    std::string indexFile;
+    std::string logFile;
+    std::vector<Chunk> chunks;
+    std::unordered_multimap<uint64_t, uint32_t> byHash; // hashLow -> chunk position
+    std::vector<BackupGeneration> generations;
+    bool loaded;
+    bool syncWrites;
+
+    bool load();
+    int findChunk(uint64_t hashLow, uint64_t hashHigh, uint32_t length) const;
+    bool appendChunks(const std::string& data, const std::vector<Chunk>& fresh);
+    bool writeIndex(const std::vector<Chunk>& fresh);
+    bool writeGeneration(const BackupGeneration& generation);
+    bool copyOut(const BackupGeneration& generation, const std::string& target) const;
+
+public:
+    explicit BackupStore(const std::string& dataFile = "events.dat");
+
+    void setSyncWrites(bool enabled) { syncWrites = enabled; }
+
+    // Backs up the data file as a new generation; returns its ID, 0 on failure
+    int create(std::time_t now);
+
+    // Replaces the data file with a generation (0 = latest), chunk by chunk
+    bool restore(int generation);
+
+    const std::vector<BackupGeneration>& list();
+    uint64_t getPackBytes(); // Disk used by all generations together
+};
+
+#endif
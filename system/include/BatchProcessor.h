@@ -0,0 +1,75 @@
+#ifndef BATCHPROCESSOR_H
+#define BATCHPROCESSOR_H
+
+#include "EventManager.h"
+#include "FileHandler.h"
+#include "EventRenderer.h"
+#include "SharedJournal.h"
+#include <istream>
+#include <string>
+#include <memory>
+#include <cstddef>
+
+// Settings for headless command execution
+struct BatchConfig {
+    std::string dataFile = "events.dat";
+    size_t checkpointEvery = 0; // Save after this many mutations, 0 = only at end
+    bool save = true;           // Persist at checkpoints and at end
+    bool compress = false;      // Save in the compressed layout
+    bool sync = true;           // Flush saves to disk before they replace the data file
+    bool shared = false;        // See and publish the changes of other shared instances
+};
+
+// Executes newline-separated commands against an EventManager without the
+// interactive menu. Fields inside a command are separated by '|':
+//
+//   add <title>|<description>|<time>|<priority>|<repeat>|<minutes>
+//   update <id>|<title>|<description>|<time>|<priority>   (empty field keeps value)
+//   overlaps <from>|<to>
+//   free <from>|<to>|<minutes>|<count>|<HH:MM-HH:MM [weekdays]>
+//   delete <id>          complete <id>          find <id>
+//   search <text>        due                    upcoming [hours]
+//   next [count]         soonest [count]        changes [after]
+//   list                 count                  stats
+//   save
+//
+// <time>, <from> and <to> are "YYYY-MM-DD HH:MM" (local time) or seconds
+// since the epoch. <repeat> and <minutes> (duration) are optional; <repeat>
+// is type[:every[:count[:until]]], e.g. "weekly:2:10". next lists pending
+// events by effective deadline, soonest by time from now; free lists up to <count>
+// (default 10) open slots of at least <minutes>, optionally within working
+// hours. changes prints the change feed after a sequence number.
+// Each command answers "OK ..." or "ERR <line>: <reason>"; queries print
+// compact table rows before their OK line.
+class BatchProcessor {
+private:
+    BatchConfig config;
+    EventManager& manager;
+    FileHandler fileHandler;
+    std::unique_ptr<SharedJournal> journal; // In shared mode
+    EventRenderer output;
+    size_t lineNumber;
+    size_t mutationsSinceSave;
+    size_t commandCount;
+    size_t errorCount;
+
+    // Helper methods
+    bool execute(const std::string& command, const std::string& args);
+    void error(const std::string& message);
+    void mutated();
+    bool checkpoint(bool force = false);
+    void listResults(const std::vector<Event>& events);
+
+public:
+    BatchProcessor(EventManager& manager, const BatchConfig& config);
+
+    bool loadData();
+
+    // Runs every command from the stream; returns false if any command failed
+    bool run(std::istream& input);
+
+    size_t getCommandCount() const { return commandCount; }
+    size_t getErrorCount() const { return errorCount; }
+};
+
+#endif
@@ -0,0 +1,86 @@
+#ifndef CALENDARREGISTRY_H
+#define CALENDARREGISTRY_H
+
+#include "EventManager.h"
+#include "FileHandler.h"
+#include "ArchiveStore.h"
+#include "UndoHistory.h"
+#include "SnapshotWriter.h"
+#include "SharedJournal.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <functional>
+#include <ctime>
+
+// One named calendar: its own event store, data file, archive and undo history
+struct Calendar {
+    std::string name;
+    EventManager events;
+    FileHandler file;
+    ArchiveStore archive;
+    UndoHistory history;
+    bool unsaved;           // Set by the change feed
+    std::time_t lastUsed;
+    std::unique_ptr<SharedJournal> shared; // In shared mode; declared last so it stops listening first
+
+    Calendar(const std::string& name, const std::string& dataFile);
+    Calendar(const Calendar&) = delete; // The change feed holds on to this
+    Calendar& operator=(const Calendar&) = delete;
+};
+
+// An event found by a query over several calendars
+struct CalendarEvent {
+    const Calendar* calendar;
+    Event event;
+};
+
+// Named calendars kept side by side: the default calendar is the data file
+// itself ("events.dat") and calendar "work" is "events.work.dat", each with
+// its own archive and backups. A calendar is loaded the first time it is
+// opened and unloaded again once idle, so only calendars in use cost memory
+// and load time.
+class CalendarRegistry {
+private:
+    std::string baseFile;
+    std::map<std::string, std::unique_ptr<Calendar>> loaded; // By name
+    bool syncWrites;
+    bool shared;
+
+    static void readFile(Calendar& calendar);
+
+public:
+    static const char* const DEFAULT_NAME;
+
+    explicit CalendarRegistry(const std::string& baseFile = "events.dat");
+
+    static bool isValidName(const std::string& name); // Letters, digits, '-' and '_'
+    std::string pathFor(const std::string& name) const;
+
+    // Every calendar with a data file or loaded, the default first; loads nothing
+    std::vector<std::string> names() const;
+
+    // Loads the calendar on first use (an unknown name starts an empty one);
+    // opened tells whether it was loaded by this call
+    Calendar& open(const std::string& name, std::time_t now, bool& opened);
+    // (Re)reads the data file, salvaging a damaged one, plus the shared
+    // journal's changes in shared mode
+    void load(Calendar& calendar);
+    bool isLoaded(const std::string& name) const { return loaded.count(name) > 0; }
+    std::vector<Calendar*> getLoaded() const;
+
+    // Hands unsaved changes to the writer (or the shared journal) and unloads
+    // calendars other than keep that were last used idleSeconds or more ago;
+    // returns how many. Nothing is unloaded while the writer has a failed save.
+    size_t evictIdle(std::time_t now, std::time_t idleSeconds, const Calendar* keep, SnapshotWriter& writer);
+
+    // Runs a query on every loaded calendar; the results are merged in list
+    // order (priority, then time)
+    std::vector<CalendarEvent> query(const std::function<std::vector<Event>(const EventManager&)>& run) const;
+
+    void setSyncWrites(bool sync); // For loaded and later calendars
+    void setShared(bool shared) { this->shared = shared; } // For calendars opened from now on
+};
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef CHANGEFEED_H
+#define CHANGEFEED_H
+
+#include "Event.h"
+#include <vector>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+
+enum class ChangeType {
+    Added,
+    Updated,   // eventId is the ID that was updated; event is the new state
+    Removed,   // event is the state before removal
+    Completed, // Recurring events report their next occurrence
+    Cleared    // Every event was dropped (e.g. before a reload); event is empty
+};
+
+struct ChangeRecord {
+    uint64_t sequence; // Strictly increasing, starting at 1
+    ChangeType type;
+    int eventId;
+    Event event;
+};
+
+typedef std::function<void(const ChangeRecord&)> ChangeObserver;
+
+// Ordered log of EventManager mutations. Observers are called synchronously
+// as each change is published; consumers that prefer to poll keep their last
+// seen sequence number and read from a bounded ring of recent records.
+class ChangeFeed {
+private:
+    std::vector<ChangeRecord> ring;
+    size_t capacity;
+    uint64_t lastSequence;
+    std::vector<std::pair<int, ChangeObserver>> observers;
+    int nextObserverId;
+
+public:
+    explicit ChangeFeed(size_t capacity = 4096);
+
+    uint64_t publish(ChangeType type, int eventId, const Event& event);
+
+    int subscribe(const ChangeObserver& observer); // Returns a handle for unsubscribe
+    void unsubscribe(int handle);
+
+    // Appends records newer than 'after' (at most max). Returns false if some
+    // were already overwritten, in which case the consumer should resync.
+    bool poll(uint64_t after, std::vector<ChangeRecord>& out, size_t max = static_cast<size_t>(-1)) const;
+
+    uint64_t getLastSequence() const { return lastSequence; }
+    uint64_t getOldestSequence() const; // Oldest record still in the ring, 0 if none
+};
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef CHECKSUM_H
+#define CHECKSUM_H
+
+#include <cstddef>
+#include <cstdint>
+
+// CRC32C (Castagnoli), as used by iSCSI, ext4 and many storage formats.
+// Uses the SSE4.2 crc32 instruction when the CPU has it, otherwise a
+// slicing-by-8 table; both give the same values.
+namespace Checksum {
+
+// Pass a previous result as crc to continue over more data
+uint32_t crc32c(const void* data, size_t size, uint32_t crc = 0);
+
+bool hardwareAccelerated();
+
+} // namespace Checksum
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <ctime>
+
+// Time source used by reminder queries. EventManager takes one snapshot
+// of now() per query instead of asking the OS once per event.
+class Clock {
+public:
+    virtual ~Clock() = default;
+    virtual std::time_t now() const = 0;
+};
+
+// Wall clock (default)
+class SystemClock : public Clock {
+public:
+    std::time_t now() const override { return std::time(nullptr); }
+
+    static SystemClock& instance() {
+        static SystemClock clock;
+        return clock;
+    }
+};
+
+// Manually driven clock for simulation and deterministic load tests
+class VirtualClock : public Clock {
+private:
+    std::time_t current;
+
+public:
+    explicit VirtualClock(std::time_t start = 0) : current(start) {}
+
+    std::time_t now() const override { return current; }
+    void set(std::time_t time) { current = time; }
+    void advance(std::time_t seconds) { current += seconds; }
+};
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef COMPRESSION_H
+#define COMPRESSION_H
+
+#include <string>
+#include <cstddef>
+
+// Small LZ77 codec in the LZ4 block style: byte-aligned sequences of
+// literals plus (offset, length) matches within a 64 KB window. Fast to
+// decode, good enough on repetitive event text; no external dependency.
+namespace Compression {
+
+// Appends the compressed form of data to out
+void compress(const char* data, size_t size, std::string& out);
+
+// Appends exactly rawSize decompressed bytes to out; false on corrupt input
+bool decompress(const char* data, size_t size, size_t rawSize, std::string& out);
+
+// Worst-case compressed size for size input bytes
+size_t compressBound(size_t size);
+
+} // namespace Compression
+
+#endif
@@ -4,16 +4,27 @@
 #include <string>
 #include <ctime>
 #include <iostream>
+#include <atomic>
+#include <memory>
+#include "Recurrence.h"
+#include "TextStore.h"
 
 class Event {
 private:
-    static int nextId;
+    static std::atomic<int> nextId; // Records are parsed on several threads at once
     int id;
-    std::string title;
-    std::string description;
+    std::shared_ptr<EventText> text; // Title and description, shared by copies
     std::time_t eventTime;
+    std::time_t duration; // Seconds; 0 = a point in time
     int priority; // 1 = High, 2 = Medium, 3 = Low
     bool isCompleted;
+    
+    // Recurrence: eventTime is the next pending occurrence of the series
+    RecurrenceRule recurrence;
+    std::time_t seriesStart;
+    long occurrenceIndex;
+    
+    explicit Event(int id); // Keeps an existing ID instead of taking a new one
 
 public:
     // Constructors
@@ -23,24 +34,37 @@ public:
     
     // Getters
     int getId() const { return id; }
-    std::string getTitle() const { return title; }
-    std::string getDescription() const { return description; }
+    std::string getTitle() const;
+    std::string getDescription() const;
     std::time_t getEventTime() const { return eventTime; }
+    std::time_t getDuration() const { return duration; }
+    std::time_t getEndTime() const { return eventTime + duration; }
     int getPriority() const { return priority; }
     bool getIsCompleted() const { return isCompleted; }
     
     // Setters
-    void setTitle(const std::string& title) { this->title = title; }
-    void setDescription(const std::string& description) { this->description = description; }
-    void setEventTime(std::time_t eventTime) { this->eventTime = eventTime; }
+    void setTitle(const std::string& title);
+    void setDescription(const std::string& description);
+    void setText(const std::string& title, const std::string& description);
+    void setEventTime(std::time_t eventTime); // Restarts a recurring series at this time
+    void setDuration(std::time_t duration) { this->duration = duration > 0 ? duration : 0; }
     void setPriority(int priority) { this->priority = priority; }
     void setCompleted(bool completed) { this->isCompleted = completed; }
     
+    // Recurrence
+    const RecurrenceRule& getRecurrence() const { return recurrence; }
+    bool isRecurring() const { return recurrence.isRecurring(); }
+    std::time_t getSeriesStart() const { return seriesStart; }
+    void setRecurrence(const RecurrenceRule& rule); // Series starts at the current event time
+    OccurrenceIterator occurrences() const { return OccurrenceIterator(recurrence, seriesStart, occurrenceIndex); }
+    bool advanceOccurrence(std::time_t after); // Moves past this occurrence to the first one after that time; false once the series is exhausted
+    Event atOccurrence(const OccurrenceIterator& occurrence) const; // Copy positioned at one occurrence
+    
     // Utility methods
     std::string getFormattedTime() const;
     std::string getPriorityString() const;
-    bool isUpcoming() const;
-    bool isDue() const;
+    bool isUpcoming(std::time_t now) const;
+    bool isDue(std::time_t now) const;
     
     // Comparison operators for sorting
     bool operator<(const Event& other) const;
@@ -50,9 +74,16 @@ public:
     // File I/O methods
     std::string serialize() const;
     static Event deserialize(const std::string& data);
+    static void reserveIds(int lastId); // Never hand out IDs up to lastId again
+    static int claimId(); // The next free ID, as a new event would take it
+    static const Event& none(); // Empty event with ID 0; takes no ID from the counter
+    Event withId(int id) const; // Copy under another ID, which is then never handed out
     
-    // Display method
-    void display() const;
+    // Display methods
+    void display(std::time_t now = std::time(nullptr)) const;
+    void render(std::string& out, std::time_t now) const;    // Detailed block, appended to out
+    void renderRow(std::string& out, std::time_t now) const; // One compact table row
+    static void renderTableHeader(std::string& out);
 };
 
 #endif
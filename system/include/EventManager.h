@@ -3,28 +3,168 @@
 
 #include "Event.h"
 #include "EventNode.h"
+#include "Clock.h"
+#include "Scheduler.h"
+#include "IntervalTree.h"
+#include "ChangeFeed.h"
+#include "PersistentEventMap.h"
 #include <vector>
 #include <queue>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <map>
+#include <utility>
+
+typedef std::function<bool(const Event&)> EventFilter;
+
+// Stable reference to a stored event from EventManager::findEvent. It stays
+// valid through updates and completion and never matches another event once
+// this one is removed, however memory is reused.
+typedef SlotHandle EventHandle;
+const EventHandle NO_EVENT = 0;
+
+// A free stretch of time, [start, end)
+struct TimeSlot {
+    std::time_t start;
+    std::time_t end;
+};
+
+// Dashboard numbers, maintained incrementally
+struct EventStats {
+    int total = 0;
+    int pending = 0;
+    int completed = 0;
+    int due = 0;      // Pending and at or before now
+    int upcoming = 0; // Pending and after now
+    int byPriority[3] = {0, 0, 0}; // All events, High/Medium/Low
+};
+
+// Optional daily window that free slots are clipped to (local time)
+struct WorkingHours {
+    bool enabled = false;
+    int startMinute = 9 * 60;  // Minutes after midnight
+    int endMinute = 17 * 60;
+    bool weekdaysOnly = false;
+};
+
+// Fields to change in a stored event; only those marked are applied
+struct EventPatch {
+    bool hasTitle = false;
+    std::string title;
+    bool hasDescription = false;
+    std::string description;
+    bool hasTime = false;
+    std::time_t eventTime = 0; // Restarts a recurring series at this time
+    bool hasDuration = false;
+    std::time_t duration = 0;
+    bool hasPriority = false;
+    int priority = 2;
+    
+    void applyTo(Event& event) const;
+};
+
+// Resumable position in the sorted event list for paged listings.
+// Only valid while the list is not modified.
+class EventCursor {
+private:
+    friend class EventManager;
+    const EventNode* next = nullptr;
+    bool started = false;
+
+public:
+    bool atEnd() const { return started && next == nullptr; }
+    void reset() { next = nullptr; started = false; }
+};
 
 class EventManager {
 private:
     EventNode* head; // Linked list for event storage
     int eventCount;
+    const Clock* clock; // Time source for due/upcoming queries
+    std::unordered_map<int, EventNode*> idIndex; // O(1) lookup by event ID
+    SlotMap<EventNode*> handles; // Nodes behind the handles given out
+    
+    // List order (priority, then time; see Event::operator<) for O(log n) inserts
+    typedef std::pair<int, std::time_t> OrderKey;
+    std::multimap<OrderKey, EventNode*> orderIndex;
+    
+    std::multimap<std::time_t, EventNode*> timeIndex; // Chronological order for "next N" queries
+    std::unordered_set<EventNode*> recurring; // Pending series, whose stored occurrence may have passed
+    Scheduler scheduler; // Pending events by effective deadline
+    IntervalTree slots;  // Time slots of pending events for conflict checks
+    
+    // Running aggregates, adjusted on every link/unlink/completion
+    int pendingCount;
+    int priorityCounts[3];
+    // Due = pending events at or before dueWatermark; the watermark catches
+    // up with the clock lazily by walking the time index over the gap
+    mutable std::time_t dueWatermark;
+    mutable int dueCount;
+    
+    ChangeFeed changes; // Every public mutation is published here
+    PersistentEventMap store; // Immutable mirror of all events for O(1) snapshots
+    
+    void account(const Event& event, int delta);
+    void advanceDueWatermark(std::time_t now) const;
     
     // Helper methods
+    EventNode* newNode(const Event& event); // With a handle
+    void deleteNode(EventNode* node);
+    EventNode* nodeFor(EventHandle handle) const;
+    void replaceEvent(EventNode* node, const Event& updated); // Repositions only if a sort key changed
     void insertSorted(const Event& event);
+    void insertNode(EventNode* node);
+    void splice(EventNode* previous, EventNode* node); // List pointers only; previous == nullptr is the head
+    void linkAfter(EventNode* previous, EventNode* node); // Splice, then attach and index the slot
+    void attach(EventNode* node); // ID index, scheduler, store and counters for a linked node
+    void bulkLoad(const std::vector<Event>& events); // Sorted merge of many events at once
+    void unlink(EventNode* node);
     EventNode* findEventById(int id);
     void clearList();
+    // Occurrences of pending series after their stored one (which the time
+    // index and slots already hold) whose slot intersects [from, to), by time
+    std::vector<Event> laterOccurrences(std::time_t from, std::time_t to) const;
+    // The same nodes in list order, using the order index to break ties
+    std::vector<const EventNode*> inListOrder(std::vector<const EventNode*> nodes) const;
+    void displayFiltered(const std::string& heading, std::time_t now,
+                         const EventFilter& filter, const std::string& emptyMessage) const;
     
 public:
-    EventManager();
+    explicit EventManager(const Clock& clock = SystemClock::instance());
     ~EventManager();
     
+    // Clock injection
+    void setClock(const Clock& clock) { this->clock = &clock; }
+    const Clock& getClock() const { return *clock; }
+    
     // Core operations
     void addEvent(const Event& event);
+    void addEvents(const std::vector<Event>& events); // One sort and merge instead of a search per event
     bool removeEvent(int id);
+    bool removeEvent(EventHandle handle);
     bool updateEvent(int id, const Event& updatedEvent);
-    Event* findEvent(int id);
+    bool updateEvent(EventHandle handle, const Event& updatedEvent); // The handle stays valid
+    // Changes some fields in place, keeping the ID and the handle
+    bool patchEvent(int id, const EventPatch& patch);
+    bool patchEvent(EventHandle handle, const EventPatch& patch);
+    void clear();
+    
+    // Lookup by handle is O(1) and checks the event is still there. The
+    // pointer is only good until the next change; keep the handle instead.
+    EventHandle findEvent(int id) const; // NO_EVENT if there is none
+    const Event* getEvent(EventHandle handle) const; // nullptr once removed
+    std::vector<Event> extractEvents(const EventFilter& filter); // Removes and returns matches
+    
+    // Snapshots: O(1) to take, safe to read from other threads while the manager
+    // keeps changing. restore() applies only the differences (undo/redo).
+    PersistentEventMap snapshot() const { return store; }
+    void restore(const PersistentEventMap& target);
+    
+    // Change notifications: subscribe for callbacks or poll by sequence number
+    ChangeFeed& getChangeFeed() { return changes; }
+    const ChangeFeed& getChangeFeed() const { return changes; }
     
     // Display operations
     void displayAllEvents() const;
@@ -32,19 +172,54 @@ public:
     void displayDueEvents() const;
     void displayEventsByPriority(int priority) const;
     
+    // Paged traversal: returns up to pageSize matching events after cursor
+    std::vector<const Event*> nextPage(EventCursor& cursor, size_t pageSize,
+                                       const EventFilter& filter = EventFilter()) const;
+    
+    // The k soonest pending events at or after now that match filter, in time order.
+    // Walks the time index, so cost depends on k (and filter misses) plus the number
+    // of recurring series, not store size. A recurring series appears once, at its
+    // first occurrence at or after now, even if its stored occurrence has passed.
+    std::vector<Event> nextEvents(size_t k, const EventFilter& filter = EventFilter()) const;
+    
+    // Conflict detection over pending events; a recurring series is checked at every
+    // occurrence that intersects the range, each returned as its own event
+    std::vector<Event> findOverlapping(std::time_t from, std::time_t to, int excludeId = 0) const;
+    std::vector<Event> findConflicts(const Event& event, int excludeId = 0) const;
+    
+    // First count gaps of at least minLength in [from, to) between pending events,
+    // clipped to working hours. Sweeps the time index from 'from' onwards, merged
+    // with the occurrences recurring series have in the range.
+    std::vector<TimeSlot> findFreeSlots(std::time_t from, std::time_t to, std::time_t minLength,
+                                        size_t count, const WorkingHours& hours = WorkingHours()) const;
+    
     // Search operations
     std::vector<Event> searchByTitle(const std::string& title) const;
     std::vector<Event> searchByDate(const std::string& date) const;
     
     // Utility operations
     int getEventCount() const { return eventCount; }
+    int getDueCount() const; // O(1) plus events that fell due since the last call
+    EventStats getStats() const;
     std::vector<Event> getAllEvents() const;
     void markEventCompleted(int id);
+    bool markEventCompleted(EventHandle handle);
     
-    // Reminder operations
+    // Reminder operations, in list order. Due events come from the slot index and
+    // upcoming ones from a time index range plus the recurring series, so both
+    // cost O(log n + results + series) rather than a walk of the whole list.
     std::vector<Event> getDueReminders() const;
     std::vector<Event> getUpcomingReminders(int hours = 24) const;
     
+    // Every occurrence starting in [from, to), recurring series expanded lazily
+    std::vector<Event> getEventsInRange(std::time_t from, std::time_t to) const;
+    
+    // Scheduling: the k pending events to handle next, by effective deadline
+    std::vector<Event> nextTasks(size_t k) const;
+    std::time_t getEffectiveDeadline(const Event& event) const { return scheduler.effectiveDeadline(event); }
+    std::time_t getAgingHorizon() const { return scheduler.getAgingHorizon(); }
+    void setAgingHorizon(std::time_t seconds) { scheduler.setAgingHorizon(seconds); }
+    
     // Sorting operations
     void sortEventsByTime();
     void sortEventsByPriority();
@@ -2,14 +2,22 @@
 #define EVENTNODE_H
 
 #include "Event.h"
+#include "SlotMap.h"
+#include <cstddef>
 
 // Node for linked list implementation
 class EventNode {
 public:
     Event event;
     EventNode* next;
+    EventNode* prev;
+    size_t heapSlot; // Position in the Scheduler heap, NOT_SCHEDULED if absent
+    SlotHandle handle; // Given out by EventManager::findEvent
     
-    EventNode(const Event& event) : event(event), next(nullptr) {}
+    static const size_t NOT_SCHEDULED = static_cast<size_t>(-1);
+    
+    EventNode(const Event& event) : event(event), next(nullptr), prev(nullptr), heapSlot(NOT_SCHEDULED),
+                                     handle(0) {}
 };
 
 #endif
@@ -0,0 +1,44 @@
+#ifndef EVENTRENDERER_H
+#define EVENTRENDERER_H
+
+#include "Event.h"
+#include <string>
+#include <ctime>
+#include <cstddef>
+
+enum class RenderFormat {
+    Detailed, // Multi-line block per event (same layout as Event::display)
+    Compact   // One table row per event
+};
+
+// Builds listing output in memory and writes it to stdout in one call
+// per flush, instead of flushing once per line.
+class EventRenderer {
+private:
+    std::string buffer;
+    RenderFormat format;
+    std::time_t now; // Snapshot used for Due/Upcoming status
+    bool tableHeaderPending;
+
+public:
+    static const size_t DEFAULT_CAPACITY = 64 * 1024;
+
+    explicit EventRenderer(RenderFormat format = RenderFormat::Detailed,
+                           std::time_t now = std::time(nullptr));
+
+    RenderFormat getFormat() const { return format; }
+    void setNow(std::time_t now) { this->now = now; }
+
+    // Content
+    void line(const std::string& text);
+    void add(const Event& event);
+    void beginTable() { tableHeaderPending = true; } // Next compact row repeats the header
+
+    size_t size() const { return buffer.size(); }
+    bool empty() const { return buffer.empty(); }
+
+    // Output: a single write of everything buffered so far
+    void flush();
+};
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef EVENTSERVER_H
+#define EVENTSERVER_H
+
+#include "EventManager.h"
+#include "FileHandler.h"
+#include "Protocol.h"
+#include "SnapshotWriter.h"
+#include <string>
+#include <unordered_map>
+#include <cstddef>
+#include <cstdint>
+
+// Settings for daemon mode
+struct ServerConfig {
+    std::string socketPath = Protocol::DEFAULT_SOCKET;
+    std::string dataFile = "events.dat";
+    int saveIntervalSeconds = 5; // Persist dirty state at most this often
+    bool syncWrites = true;      // Flush each save to disk before it replaces the data file
+};
+
+// Serves one in-memory EventManager to local clients over a Unix-domain
+// socket. Single-threaded: one epoll loop owns every connection, so
+// requests never race on the store. Linux only.
+class EventServer {
+private:
+    struct Connection {
+        std::string input;
+        size_t inputOffset = 0;
+        std::string output;
+        size_t outputOffset = 0;
+        uint32_t interest = 0; // epoll events currently registered
+        bool peerClosed = false; // Peer finished sending; close once output drains
+    };
+
+    ServerConfig config;
+    EventManager& manager;
+    FileHandler fileHandler;
+    int listenFd;
+    int epollFd;
+    bool dirty;      // Set by the change feed
+    int feedHandle;
+    std::unordered_map<int, Connection> connections;
+    SnapshotWriter snapshotWriter; // Keeps saves off the event loop
+
+    // Helper methods
+    bool openSocket();
+    void acceptClients();
+    bool readClient(int fd, Connection& connection);
+    bool writeClient(int fd, Connection& connection);
+    void closeClient(int fd);
+    void updateInterest(int fd, Connection& connection);
+    bool processFrames(Connection& connection);
+    void handleRequest(uint8_t opcode, uint32_t requestId, Protocol::Reader& reader, std::string& out);
+    void writeEvents(const std::vector<Event>& events, uint32_t requestId, std::string& out);
+    void persist();
+
+public:
+    EventServer(EventManager& manager, const ServerConfig& config);
+    ~EventServer();
+
+    bool loadData();
+
+    // Runs until SIGINT/SIGTERM; returns false if the socket could not be opened
+    bool run();
+};
+
+#endif
@@ -3,19 +3,77 @@
 
 #include "EventManager.h"
 #include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
 
+// A stretch of the data file that could not be read
+struct DamagedRegion {
+    uint64_t offset;
+    uint64_t length;
+    std::string reason;
+};
+
+// What the last loadEvents found
+struct LoadReport {
+    size_t expected = 0; // Events the file says it holds
+    size_t loaded = 0;
+    std::vector<DamagedRegion> damage;
+};
+
+// Reads and writes the data file. Two layouts share the same records
+// ([u32 length][u32 CRC32C of the data][serialized event]):
+//
+//   plain       ["EVREC002"][u64 count][record]...
+//   compressed  ["EVZBLK02"][block header][block]...[block index][footer]
+//
+// A compressed block holds ~128KB of records run through Compression. Block
+// headers and the index carry checksums too, and the index lets loading
+// decompress all blocks in parallel. Loading detects the layout (files from
+// before checksums still load); saving uses the compressed one once it is
+// enabled or loaded. Damage fails the load unless recovery mode is on, in
+// which case the damaged regions are skipped and listed in the report.
+//
+// Saves never touch the data file in place: they write <data>.tmp, flush it
+// to disk and rename it over the data file, so a crash leaves either the old
+// or the new version. Turning sync off skips the flushes (faster, but a power
+// loss may then lose the last saves).
 class FileHandler {
 private:
     std::string filename;
+    bool compressed;
+    bool recovery;
+    bool syncWrites;
+    LoadReport report;
+    
+    std::string tempName() const { return filename + ".tmp"; }
+    bool commitFile(std::ofstream& file, const std::string& temp) const; // Sync and rename into place
+    bool saveCompressed(const PersistentEventMap& snapshot) const;
+    bool loadPlain(std::ifstream& file, bool checked, EventManager& manager);
+    bool recoverPlain(const std::string& data, bool checked, EventManager& manager);
+    bool loadCompressed(const std::string& data, bool checked, EventManager& manager);
+    bool damaged(uint64_t offset, uint64_t length, const std::string& reason); // False unless recovering
+    void finishLoad(std::vector<Event>& events, EventManager& manager);
     
 public:
     FileHandler(const std::string& filename = "events.dat");
     
     bool saveEvents(const EventManager& manager);
+    bool saveSnapshot(const PersistentEventMap& snapshot) const;
     bool loadEvents(EventManager& manager);
+    void setCompressed(bool enabled) { compressed = enabled; }
+    bool isCompressed() const { return compressed; }
+    void setSyncWrites(bool enabled) { syncWrites = enabled; }
+    bool getSyncWrites() const { return syncWrites; }
+    void setRecoveryMode(bool enabled) { recovery = enabled; }
+    const LoadReport& getLoadReport() const { return report; }
+    // Keeps the damaged file as a backup generation, then loads what can be
+    // read from it into the (cleared) manager; false if no backup could be made
+    bool recoverEvents(EventManager& manager);
     bool fileExists() const;
-    bool createBackup() const;
-    bool restoreFromBackup();
+    const std::string& getFilename() const { return filename; }
+    int createBackup() const; // New backup generation ID, 0 on failure
+    bool restoreFromBackup(int generation = 0); // 0 = latest generation
 };
 
 #endif
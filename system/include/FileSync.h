@@ -0,0 +1,24 @@
+#ifndef FILESYNC_H
+#define FILESYNC_H
+
+#include <string>
+
+// Durability helpers for the files the stores write. Only Linux flushes;
+// elsewhere the sync calls succeed without doing anything.
+namespace FileSync {
+
+// Flushes a file's data to the disk
+bool syncFile(const std::string& path);
+
+// Flushes the entries of the directory holding path, so that creating or
+// renaming the file survives a crash
+bool syncParent(const std::string& path);
+
+// Atomically puts temp in place of target, replacing it if it exists (rename
+// does not replace on Windows, so MoveFileEx does it there). With sync the
+// directory is flushed afterwards so the swap itself survives a crash.
+bool replaceFile(const std::string& temp, const std::string& target, bool sync);
+
+} // namespace FileSync
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef INTERCHANGE_H
+#define INTERCHANGE_H
+
+#include "EventManager.h"
+#include <string>
+#include <cstddef>
+
+enum class InterchangeFormat {
+    ICalendar, // RFC 5545 VEVENTs (.ics)
+    Csv
+};
+
+// Outcome of an import or export
+struct InterchangeStats {
+    size_t events = 0;  // Imported or written
+    size_t skipped = 0; // Entries that could not be turned into events
+    size_t bytes = 0;   // Read or written
+};
+
+// Streaming import and export for moving calendars in and out. Input is read
+// in fixed-size chunks and tokenized in place; only values that are folded,
+// quoted with escapes or backslash-escaped get copied. Imported events reach
+// the manager in batches, so memory use depends on the chunk and batch sizes,
+// not on the file. Exports page through the store and write as they go.
+//
+// iCalendar: SUMMARY, DESCRIPTION, DTSTART, DTEND or DURATION, PRIORITY,
+// RRULE (FREQ, INTERVAL, COUNT, UNTIL) and STATUS are read; other properties
+// and nested components such as alarms are ignored.
+//
+// CSV needs a header row; columns are matched by name in any order:
+//   Subject, Start Date, Start Time, End Date, End Time, Description,
+//   Priority, Completed, Repeat
+// Dates are YYYY-MM-DD or MM/DD/YYYY and times HH:MM[:SS] [AM|PM], in local
+// time. Repeat uses the batch-mode form ("weekly:2:10").
+namespace Interchange {
+
+bool formatFor(const std::string& path, InterchangeFormat& format); // From the file extension
+
+bool importFile(const std::string& path, InterchangeFormat format, EventManager& manager,
+                InterchangeStats& stats);
+bool exportFile(const std::string& path, InterchangeFormat format, const EventManager& manager,
+                InterchangeStats& stats);
+
+} // namespace Interchange
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef INTERVALTREE_H
+#define INTERVALTREE_H
+
+#include "EventNode.h"
+#include <vector>
+#include <ctime>
+#include <cstdint>
+
+// Augmented interval tree over event time slots [start, end). Nodes are
+// ordered by (start, event ID) in a treap and carry the largest end time in
+// their subtree, so an overlap query skips every subtree that ends before
+// the slot or starts after it: O(log n + k) expected for k matches.
+class IntervalTree {
+private:
+    struct Node {
+        std::time_t start;
+        std::time_t end;
+        std::time_t maxEnd;
+        int id;
+        uint32_t weight; // Treap heap priority
+        EventNode* event;
+        Node* left;
+        Node* right;
+    };
+
+    Node* root;
+    size_t count;
+    uint32_t seed;
+
+    uint32_t nextWeight();
+    Node* makeNode(EventNode* event);
+    static bool keyLess(std::time_t startA, int idA, std::time_t startB, int idB);
+    static void refresh(Node* node);
+    static void split(Node* node, std::time_t start, int id, Node*& left, Node*& right);
+    static Node* merge(Node* left, Node* right);
+    static Node* unite(Node* a, Node* b); // Union of two treaps with distinct keys
+    static void destroy(Node* node);
+    static void collect(const Node* node, std::time_t from, std::time_t to,
+                        std::vector<const EventNode*>& out);
+
+public:
+    IntervalTree();
+    ~IntervalTree();
+    IntervalTree(const IntervalTree&) = delete;
+    IntervalTree& operator=(const IntervalTree&) = delete;
+
+    // The slot an event occupies; events without a duration take their start minute
+    static std::time_t slotEnd(const Event& event);
+
+    void insert(EventNode* event);
+    // Sorts and builds the new nodes in O(n), then merges them into the tree in
+    // O(m log(n/m + 1)) for m new nodes
+    void insertAll(std::vector<EventNode*> events);
+    bool erase(const EventNode* event); // Uses the event's current start time and ID
+    void clear();
+    size_t size() const { return count; }
+
+    // Events whose slot intersects [from, to), in start time order
+    std::vector<const EventNode*> overlapping(std::time_t from, std::time_t to) const;
+};
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef LOADGENERATOR_H
+#define LOADGENERATOR_H
+
+#include "Protocol.h"
+#include <string>
+#include <cstddef>
+
+// Settings for a load test against a running server
+struct LoadConfig {
+    std::string socketPath = Protocol::DEFAULT_SOCKET;
+    int connections = 4;
+    size_t requestsPerConnection = 50000;
+    size_t pipelineDepth = 16;   // Requests in flight per connection
+    int writePercent = 20;       // Share of ADD/REMOVE requests, rest are FIND/SEARCH/UPCOMING
+};
+
+// Drives a local EventServer with pipelined requests from several
+// connections and reports throughput and latency percentiles.
+class LoadGenerator {
+private:
+    LoadConfig config;
+
+public:
+    explicit LoadGenerator(const LoadConfig& config) : config(config) {}
+
+    bool run();
+};
+
+#endif
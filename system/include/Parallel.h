@@ -0,0 +1,21 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <functional>
+#include <cstddef>
+
+// Data-parallel loops for bulk work such as loading. Threads are started per
+// call, so use this for a few large jobs, not for many small ones.
+namespace Parallel {
+
+// Threads forEach would use for count tasks (1 means it runs inline)
+unsigned workerCount(size_t count);
+
+// Runs task(i) for every i in [0, count). Indices are handed out one at a
+// time, so uneven tasks still balance. The first exception thrown by a task
+// is rethrown here after all threads have stopped.
+void forEach(size_t count, const std::function<void(size_t index)>& task);
+
+} // namespace Parallel
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef PERSISTENTEVENTMAP_H
+#define PERSISTENTEVENTMAP_H
+
+#include "Event.h"
+#include <memory>
+#include <vector>
+#include <functional>
+#include <cstdint>
+
+// Immutable hash array mapped trie from event ID to event. Every update
+// returns a new map that shares all untouched nodes with the old one, so a
+// copy of the map is an O(1) snapshot and old versions stay valid (and
+// readable from other threads) for as long as someone holds them.
+class PersistentEventMap {
+public:
+    typedef std::shared_ptr<const Event> Value;
+    typedef std::function<void(const Event* before, const Event* after)> DiffVisitor;
+
+private:
+    struct Node;
+    typedef std::shared_ptr<const Node> NodePtr;
+
+    // A slot holds either a child node or (when child is null) one event
+    struct Slot {
+        NodePtr child;
+        Value value;
+    };
+
+    // 32-way branch on 5 bits of the ID; only present slots are stored
+    struct Node {
+        uint32_t bitmap = 0;
+        std::vector<Slot> slots;
+    };
+
+    NodePtr root;
+    size_t count;
+
+    PersistentEventMap(const NodePtr& root, size_t count) : root(root), count(count) {}
+
+    static uint32_t keyOf(const Value& value) { return static_cast<uint32_t>(value->getId()); }
+    static std::shared_ptr<Node> writable(const NodePtr& node, bool inPlace);
+    static NodePtr insert(const NodePtr& node, const Value& value, unsigned shift, bool inPlace, bool& added);
+    static NodePtr remove(const NodePtr& node, uint32_t key, unsigned shift, bool inPlace, bool& removed);
+    static NodePtr join(const Value& a, const Value& b, unsigned shift);
+    static void collect(const Slot& slot, std::vector<Value>& out);
+    static void diffSlots(const Slot* a, const Slot* b, unsigned shift, const DiffVisitor& visit);
+    static void diffNodes(const Node& a, const Node& b, unsigned shift, const DiffVisitor& visit);
+
+public:
+    PersistentEventMap() : count(0) {}
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    Value find(int id) const;
+
+    PersistentEventMap set(const Value& event) const; // Insert or replace by event ID
+    PersistentEventMap erase(int id) const;
+    
+    // Same as set/erase but replace this map, reusing nodes that no other
+    // version refers to instead of copying them
+    void assign(const Value& event);
+    void remove(int id);
+
+    // True if both maps are the same version (pointer comparison)
+    bool sameAs(const PersistentEventMap& other) const { return root == other.root; }
+
+    void forEach(const std::function<void(const Event&)>& visit) const;
+    
+    // Disjoint parts for walking the map on several threads: visiting every
+    // part from 0 to partCount() - 1 visits each event once
+    size_t partCount() const { return root ? root->slots.size() : 0; }
+    void forEachInPart(size_t part, const std::function<void(const Event&)>& visit) const;
+
+    // Reports every ID whose event differs between the maps. Shared subtrees
+    // are skipped, so the cost follows the number of changes, not the size.
+    // before is null for additions, after is null for removals.
+    static void diff(const PersistentEventMap& from, const PersistentEventMap& to, const DiffVisitor& visit);
+};
+
+#endif
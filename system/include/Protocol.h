@@ -0,0 +1,98 @@
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#include "Event.h"
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Binary protocol spoken over the local server socket.
+//
+// Every message is a frame:
+//   [u32 body length][u8 opcode or status][u32 request id][payload]
+// The length covers everything after the length field itself. Integers
+// are in host byte order (the socket is local only). Clients may send
+// any number of requests before reading responses; responses come back
+// in request order and echo the request id.
+namespace Protocol {
+
+const size_t HEADER_SIZE = 4 + 1 + 4;
+const uint32_t MAX_BODY = 16 * 1024 * 1024;
+const char* const DEFAULT_SOCKET = "event_reminder.sock";
+
+enum Opcode : uint8_t {
+    OP_PING = 0,
+    OP_ADD = 1,        // str title, str description, i64 time, u8 priority -> i32 id
+    OP_REMOVE = 2,     // i32 id -> (empty)
+    OP_FIND = 3,       // i32 id -> event
+    OP_SEARCH = 4,     // str text -> event list
+    OP_DUE = 5,        // (empty) -> event list
+    OP_UPCOMING = 6,   // i32 hours -> event list
+    OP_COMPLETE = 7    // i32 id -> (empty)
+};
+
+enum Status : uint8_t {
+    STATUS_OK = 0,
+    STATUS_NOT_FOUND = 1,
+    STATUS_BAD_REQUEST = 2
+};
+
+// Decoded form of an encoded event
+struct EventRecord {
+    int32_t id = 0;
+    int64_t time = 0;
+    uint8_t priority = 0;
+    bool completed = false;
+    std::string title;
+    std::string description;
+};
+
+// Appends encoded values to a frame under construction
+class Writer {
+private:
+    std::string& out;
+    size_t start;
+
+public:
+    // Reserves the header; finish() fills in the body length
+    Writer(std::string& out, uint8_t code, uint32_t requestId);
+
+    void u8(uint8_t value);
+    void i32(int32_t value);
+    void u32(uint32_t value);
+    void i64(int64_t value);
+    void str(const std::string& value);
+    void event(const Event& event);
+    void finish();
+};
+
+// Decodes values from a received payload; any overrun sets ok() to false
+class Reader {
+private:
+    const char* data;
+    size_t size;
+    size_t offset;
+    bool valid;
+
+    bool take(void* value, size_t length);
+
+public:
+    Reader(const char* data, size_t size) : data(data), size(size), offset(0), valid(true) {}
+
+    bool ok() const { return valid; }
+    uint8_t u8();
+    int32_t i32();
+    uint32_t u32();
+    int64_t i64();
+    std::string str();
+    EventRecord event();
+};
+
+// Returns the total frame size if a complete frame starts at data, 0 if
+// more bytes are needed, or SIZE_MAX for a malformed length.
+size_t frameSize(const char* data, size_t available);
+
+} // namespace Protocol
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef RECURRENCE_H
+#define RECURRENCE_H
+
+#include <string>
+#include <ctime>
+
+enum class RecurrenceType {
+    None,
+    Daily,    // Every N days at the same local time
+    Weekly,   // Every N weeks at the same local time
+    Monthly,  // Every N months on the same day (clamped to the month's last day)
+    Interval  // Every N seconds
+};
+
+// How an event repeats. A recurring event is stored once; its occurrences
+// are computed on demand.
+struct RecurrenceRule {
+    RecurrenceType type = RecurrenceType::None;
+    long every = 1;        // Step in days/weeks/months, or seconds for Interval
+    long count = 0;        // Total occurrences, 0 = unlimited
+    std::time_t until = 0; // Last allowed occurrence time, 0 = no end date
+
+    bool isRecurring() const { return type != RecurrenceType::None; }
+
+    // Start time of occurrence k (k = 0 is the series start), ignoring limits
+    std::time_t occurrence(std::time_t seriesStart, long k) const;
+    bool withinLimits(std::time_t time, long k) const;
+
+    // Human readable ("Every 2 weeks, 10 times") and compact ("weekly:2:10") forms
+    std::string describe() const;
+    std::string toString() const;
+    static bool parse(const std::string& text, RecurrenceRule& rule);
+};
+
+// Walks the occurrences of a series one at a time. next() and seek() are
+// O(1): occurrences are computed from the series start, not accumulated.
+class OccurrenceIterator {
+private:
+    RecurrenceRule rule;
+    std::time_t seriesStart;
+    long index;
+    std::time_t current;
+    bool valid;
+
+    void load();
+
+public:
+    OccurrenceIterator(const RecurrenceRule& rule, std::time_t seriesStart, long index = 0);
+
+    bool isValid() const { return valid; }
+    std::time_t time() const { return current; }
+    long getIndex() const { return index; }
+
+    void next();
+    void seek(std::time_t time); // Move to the first occurrence at or after time
+};
+
+#endif
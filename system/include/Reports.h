@@ -0,0 +1,58 @@
+#ifndef REPORTS_H
+#define REPORTS_H
+
+#include "PersistentEventMap.h"
+#include <string>
+#include <vector>
+#include <ctime>
+#include <cstddef>
+
+// Events starting on one local day
+struct DayCount {
+    std::time_t day; // Local midnight
+    int total;
+    int completed;
+};
+
+// Pending events that fell due in one local week
+struct WeekCount {
+    std::time_t week; // Monday 00:00 local time
+    int overdue;
+};
+
+struct PriorityCount {
+    int total = 0;
+    int completed = 0;
+};
+
+// Aggregates over the whole store. A recurring series counts once, at its
+// next pending occurrence, as everywhere else.
+struct EventReport {
+    std::time_t generatedAt = 0;
+    size_t events = 0;
+    PriorityCount byPriority[3]; // High/Medium/Low
+    std::vector<DayCount> perDay;         // Days with events, in order
+    std::vector<WeekCount> overdueByWeek; // Weeks with overdue events, in order
+};
+
+// Analytics over a snapshot, so they can run while the store keeps changing.
+// Each report is one pass over the events split across all cores. Events are
+// counted per quarter hour (every UTC offset is a multiple of one), which are
+// then rolled up into local days and weeks with one date conversion per day.
+namespace Reports {
+
+EventReport build(const PersistentEventMap& events, std::time_t now);
+
+// Appends a readable report to out; days and weeks beyond limit are summed up
+void render(const EventReport& report, std::string& out, size_t limit = 31);
+
+// Writes the raw event columns for external analysis tools, one array per
+// column in native byte order:
+//   ["EVCOL001"][Rows (8)][Title Bytes (8)]
+//   [ID (4)] [Time (8)] [Duration (8)] [Priority (1)] [Completed (1)] per row
+//   [Title Offset (8)] per row plus the end offset, then the titles
+bool exportColumns(const std::string& path, const PersistentEventMap& events, size_t& bytes);
+
+} // namespace Reports
+
+#endif
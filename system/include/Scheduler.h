@@ -0,0 +1,45 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include "EventNode.h"
+#include <vector>
+#include <ctime>
+
+// Earliest-effective-deadline ordering of pending events. Priority is a
+// handicap on the deadline: each level below High pushes the event back by
+// agingHorizon seconds, so a Low event overtakes a High one once its own
+// deadline is more than 2 * agingHorizon earlier. The key never depends on
+// the current time, so the heap stays valid as time passes.
+class Scheduler {
+private:
+    std::vector<EventNode*> heap; // Binary min-heap; nodes remember their slot
+    std::time_t agingHorizon;
+
+    std::time_t keyOf(const EventNode* node) const;
+    bool before(const EventNode* a, const EventNode* b) const;
+    void place(size_t slot, EventNode* node);
+    void siftUp(size_t slot);
+    void siftDown(size_t slot);
+
+public:
+    static const std::time_t DEFAULT_AGING_HORIZON = 12 * 3600;
+
+    explicit Scheduler(std::time_t agingHorizon = DEFAULT_AGING_HORIZON);
+
+    // O(log n) maintenance
+    void push(EventNode* node);
+    void erase(EventNode* node);  // No-op if the node is not scheduled
+    void update(EventNode* node); // Call after the node's time or priority changed
+    void clear();
+
+    std::time_t getAgingHorizon() const { return agingHorizon; }
+    void setAgingHorizon(std::time_t horizon); // Rebuilds the heap, O(n)
+    std::time_t effectiveDeadline(const Event& event) const;
+
+    size_t size() const { return heap.size(); }
+
+    // The k most urgent events in order, O(k log k) without disturbing the heap
+    std::vector<const EventNode*> top(size_t k) const;
+};
+
+#endif
@@ -0,0 +1,89 @@
+#ifndef SHAREDJOURNAL_H
+#define SHAREDJOURNAL_H
+
+#include "EventManager.h"
+#include "FileHandler.h"
+#include <functional>
+#include <unordered_set>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+// Lets several processes work on one data file at once (shared mode, Linux).
+// Each change is appended to a journal next to the data file ("events.dat"
+// -> "events.dat.shared") that every process maps into memory, so a process
+// sees the others' changes by reading only what was added since it last
+// looked, without re-reading or re-parsing the data file. Once in a while a
+// process folds the journal into the data file (compaction) and empties it;
+// the others notice the new generation and reload the data file once.
+//
+// Processes take an flock on the journal: shared to read, exclusive to append
+// or compact. The kernel drops the lock if a process dies holding it.
+//
+// Journal layout, all offsets from the start of the file:
+//   [Header (64)]: "EVJRNL01", generation (8), end offset (8), capacity (8)
+//   then entries: [Payload Size (4)][Event ID (4)][Op (1)][Payload]
+// A "put" entry's payload is the event serialized as in the data file; a
+// "remove" entry has none. Entries are full states, so when two processes
+// change the same event the later entry wins, in every process alike.
+class SharedJournal {
+private:
+    struct Entry {
+        bool remove;
+        int id;
+        Event event; // State to put
+    };
+
+    FileHandler& file;
+    EventManager& events;
+    std::function<bool()> readFile; // Loads the data file into events
+    std::string path;
+    int fd;
+    char* map;
+    uint64_t generation; // Of the journal this process has read
+    uint64_t readOffset; // Up to here
+    std::vector<Entry> pending; // Local changes not yet appended
+    std::unordered_set<int> pendingIds;
+    std::unordered_set<int> addedIds; // Of those, events created here
+    bool applying; // Changes made by replaying are not journaled again
+    int observer;
+
+    void record(const ChangeRecord& change);
+    void queue(bool remove, int id, const Event& event, bool added);
+    size_t catchUp();  // Applies the others' entries; with the lock held
+    bool reload();     // After a compaction elsewhere
+    void apply(bool remove, int id, const char* payload, size_t size);
+    int renumber(int id); // Moves our pending new event off an ID another process used
+    bool appendPending();
+    bool grow(uint64_t needed);
+    void syncRange(uint64_t from, uint64_t to);
+
+public:
+    SharedJournal(FileHandler& file, EventManager& events);
+    ~SharedJournal();
+    SharedJournal(const SharedJournal&) = delete;
+    SharedJournal& operator=(const SharedJournal&) = delete;
+
+    bool open(); // Maps the journal, creating it if needed
+    const std::string& getPath() const { return path; }
+
+    // Reads the data file with readFile and replays the journal over it, as
+    // one consistent version; readFile is used again for later reloads.
+    // Returns what readFile did.
+    bool load(const std::function<bool()>& readFile);
+
+    // Appends local changes and applies everyone else's; call between
+    // operations, never while the manager is being walked. Returns how many
+    // outside changes came in (a reload counts as one).
+    size_t sync();
+
+    // Syncs, then saves the data file and empties the journal
+    bool compact();
+
+    // The data file was replaced (e.g. restored from a backup): empties the
+    // journal so that every process reloads it
+    void reset();
+};
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+#include "EventManager.h"
+#include "Clock.h"
+#include <string>
+#include <cstddef>
+
+// Settings for a virtual-time replay
+struct SimulationConfig {
+    size_t eventCount = 100000;          // Synthetic events to generate (ignored with dataFile)
+    std::string dataFile;                // Replay this data file instead of synthetic events
+    std::time_t span = 7 * 24 * 3600;    // Virtual seconds covered by synthetic events
+    std::time_t tick = 1;                // Virtual seconds per dispatcher step
+    int upcomingHours = 1;               // Window of the upcoming query made on every step
+    double speed = 0.0;                  // Virtual/real ratio to pace at, 0 = unthrottled
+    unsigned seed = 42;
+};
+
+// Calls of one EventManager query during a replay
+struct QueryTiming {
+    size_t calls = 0;
+    double totalMs = 0.0;
+    double maxMs = 0.0;
+};
+
+// Results of a replay
+struct SimulationReport {
+    size_t eventsLoaded = 0;
+    size_t remindersFired = 0;
+    size_t dueAtEnd = 0;                 // getDueCount() after the run; 0 once all were acknowledged
+    double virtualSeconds = 0.0;
+    double wallSeconds = 0.0;
+    double speedup = 0.0;                // Virtual seconds per wall second
+    double firingRate = 0.0;             // Reminders fired per wall second
+    double avgLateness = 0.0;            // Virtual seconds between event time and getDueReminders() returning it
+    double p99Lateness = 0.0;
+    double maxLateness = 0.0;
+    double maxWallLagMs = 0.0;           // Only measured when paced (speed > 0)
+    QueryTiming dueCount;                // Every step
+    QueryTiming dueReminders;            // Steps where something is due
+    QueryTiming upcomingReminders;       // Every step
+};
+
+// Replays an event set through virtual time and measures reminder firing.
+// Each step runs the manager's own reminder queries under the virtual clock,
+// as the menu would: the due count, the upcoming list, and when anything is
+// due, the due list, whose events are then acknowledged (marked completed).
+class Simulator {
+private:
+    SimulationConfig config;
+    VirtualClock clock;
+    EventManager manager;
+
+    // Helper methods
+    bool loadEvents();
+    void generateEvents(std::time_t start);
+
+public:
+    explicit Simulator(const SimulationConfig& config);
+
+    bool run(SimulationReport& report);
+    static void printReport(const SimulationReport& report);
+};
+
+#endif
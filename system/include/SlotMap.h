@@ -0,0 +1,100 @@
+#ifndef SLOTMAP_H
+#define SLOTMAP_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Reference to an item in a SlotMap: the slot index in the low 32 bits and
+// the slot's generation in the high 32. Zero is never handed out.
+typedef uint64_t SlotHandle;
+
+// Values in reusable slots, reached through handles that stay cheap to check:
+// a slot's generation is odd while occupied and moves on every time it is
+// freed, so a handle to a removed item never matches again, even after the
+// slot is reused. Lookup is one index and one compare.
+template <typename T>
+class SlotMap {
+private:
+    static const uint32_t NO_SLOT = static_cast<uint32_t>(-1);
+
+    struct Slot {
+        T value;
+        uint32_t generation; // Odd = occupied
+        uint32_t nextFree;
+    };
+    std::vector<Slot> slots;
+    uint32_t freeHead;
+    size_t count;
+
+    static SlotHandle handleFor(uint32_t index, uint32_t generation) {
+        return (static_cast<SlotHandle>(generation) << 32) | index;
+    }
+
+    // The slot a live handle points at, or nullptr
+    const Slot* find(SlotHandle handle) const {
+        uint32_t index = static_cast<uint32_t>(handle);
+        if (index >= slots.size()) return nullptr;
+        const Slot& slot = slots[index];
+        return slot.generation == static_cast<uint32_t>(handle >> 32) && (slot.generation & 1) ? &slot : nullptr;
+    }
+
+    void release(uint32_t index) {
+        Slot& slot = slots[index];
+        slot.value = T();
+        // A slot whose generations have run out is retired rather than risk
+        // matching a handle from 2^31 reuses ago
+        if (++slot.generation == 0) return;
+        slot.nextFree = freeHead;
+        freeHead = index;
+    }
+
+public:
+    static const SlotHandle NONE = 0;
+
+    SlotMap() : freeHead(NO_SLOT), count(0) {}
+
+    SlotHandle insert(const T& value) {
+        uint32_t index = freeHead;
+        if (index != NO_SLOT) {
+            freeHead = slots[index].nextFree;
+        } else {
+            index = static_cast<uint32_t>(slots.size());
+            slots.push_back(Slot{T(), 0, NO_SLOT});
+        }
+        Slot& slot = slots[index];
+        slot.value = value;
+        ++slot.generation;
+        ++count;
+        return handleFor(index, slot.generation);
+    }
+
+    T* get(SlotHandle handle) {
+        return const_cast<T*>(static_cast<const SlotMap*>(this)->get(handle));
+    }
+    const T* get(SlotHandle handle) const {
+        const Slot* slot = find(handle);
+        return slot ? &slot->value : nullptr;
+    }
+    bool contains(SlotHandle handle) const { return find(handle) != nullptr; }
+
+    bool erase(SlotHandle handle) {
+        if (!find(handle)) return false;
+        release(static_cast<uint32_t>(handle));
+        --count;
+        return true;
+    }
+
+    // Frees every slot; handles given out so far stay invalid
+    void clear() {
+        for (uint32_t index = 0; index < slots.size(); ++index) {
+            if (slots[index].generation & 1) release(index);
+        }
+        count = 0;
+    }
+
+    void reserve(size_t capacity) { slots.reserve(capacity); }
+    size_t size() const { return count; }
+};
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef SNAPSHOTWRITER_H
+#define SNAPSHOTWRITER_H
+
+#include "PersistentEventMap.h"
+#include "FileHandler.h"
+#include <string>
+#include <map>
+#include <utility>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+
+// How saving has gone so far
+struct CommitStats {
+    uint64_t submitted = 0; // Snapshots handed to submit()
+    uint64_t commits = 0;   // Files actually written; fewer when submissions were grouped
+    uint64_t failures = 0;
+    double totalSeconds = 0; // Time spent writing and syncing
+    double maxSeconds = 0;
+};
+
+// Writes snapshots to data files on a background thread so saving never
+// blocks the caller. Only the newest snapshot per file is kept: if the
+// writer falls behind, intermediate versions are skipped.
+//
+// Group commit: after the first change, the writer waits for the commit
+// delay so that changes arriving meanwhile share one (synced) write. A
+// longer delay means fewer disk flushes but more recent changes at risk;
+// flush() and shutdown cut the wait short.
+//
+// A snapshot whose write fails is kept until a newer one for the same file
+// replaces it; flush() tries it again and reports whether it got through.
+class SnapshotWriter {
+private:
+    std::map<std::string, std::pair<FileHandler, PersistentEventMap>> pending; // By path
+    std::map<std::string, std::pair<FileHandler, PersistentEventMap>> failed;  // By path
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    bool busy;
+    bool stopping;
+    int flushing; // Callers waiting in flush()
+    std::chrono::milliseconds commitDelay;
+    CommitStats stats;
+    std::thread worker;
+
+    void run();
+
+public:
+    SnapshotWriter();
+    ~SnapshotWriter(); // Finishes pending writes
+
+    SnapshotWriter(const SnapshotWriter&) = delete;
+    SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+    // Saves through a copy of target, so its current format settings apply
+    void submit(const FileHandler& target, const PersistentEventMap& snapshot);
+    bool flush(); // Blocks until everything submitted so far is written; false if some write failed
+
+    void setCommitDelay(std::chrono::milliseconds delay);
+    std::chrono::milliseconds getCommitDelay();
+    CommitStats getStats();
+};
+
+#endif
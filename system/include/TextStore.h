@@ -0,0 +1,97 @@
+#ifndef TEXTSTORE_H
+#define TEXTSTORE_H
+
+#include <string>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <map>
+#include <cstdio>
+#include <cstdint>
+#include <cstddef>
+
+// Title and description of one event. Never changed once made, so every copy
+// of the event (list node, snapshots, query results) shares the same one.
+// Read it through TextStore, which may have moved it to the spill file.
+class EventText {
+private:
+    friend class TextStore;
+    static const uint64_t NO_SLOT = static_cast<uint64_t>(-1);
+
+    std::string title;
+    std::string description;
+    const bool tracked; // Under the memory limit; fixed at creation, so untracked text is read without locking
+    bool spilled;       // Description (and title, if titles spill) only in the spill file
+    uint32_t titleLength;
+    uint32_t descriptionLength;
+    uint64_t slot;      // Offset in the spill file once written there
+    uint32_t slotSize;
+    EventText* newer;   // LRU list of resident tracked text
+    EventText* older;
+
+public:
+    EventText(std::string title, std::string description, bool tracked);
+    ~EventText();
+    EventText(const EventText&) = delete;
+    EventText& operator=(const EventText&) = delete;
+};
+
+struct TextStoreStats {
+    size_t limit = 0;         // Bytes; 0 = no limit
+    size_t residentBytes = 0; // Text under the limit currently in memory
+    size_t texts = 0;         // Events whose text is under the limit
+    size_t spilled = 0;       // Of those, in the spill file right now
+    uint64_t faults = 0;      // Reads that went to the spill file
+    uint64_t spillFileBytes = 0;
+};
+
+// Memory-bounded event text for small devices. With a limit set, the text of
+// events created from then on counts against it; once over, the least
+// recently used descriptions (and titles, if enabled) are written to a spill
+// file and read back on demand. Times, priorities and the rest of an event
+// stay in memory, so scheduling and sorting never touch the disk.
+//
+// The spill file is a heap of slots: each text is written once (text never
+// changes) and its slot is reused after the event is gone. It is deleted
+// when the program ends.
+class TextStore {
+private:
+    std::mutex mutex;
+    std::FILE* file;
+    std::string path;
+    std::atomic<size_t> limit; // 0 until enabled
+    bool spillTitles;          // Fixed before any text is tracked
+    uint64_t fileEnd;
+    std::multimap<uint32_t, uint64_t> freeSlots; // Size -> offset
+    EventText* newest;
+    EventText* oldest;
+    TextStoreStats stats;
+
+    TextStore();
+    size_t spillableBytes(const EventText& text) const;
+    void link(EventText& text);   // As most recently used
+    void unlink(EventText& text);
+    void touch(EventText& text);
+    void fault(EventText& text);  // Reads spilled text back in
+    bool spill(EventText& text);
+    void evictOverLimit(const EventText* keep);
+
+public:
+    static TextStore& instance();
+
+    // Starts spilling to path (truncated) beyond limitBytes; false if the
+    // file can't be created. Text that already exists is not covered.
+    bool enable(const std::string& path, size_t limitBytes, bool spillTitles);
+    bool isEnabled() const { return limit > 0; }
+    void setLimit(size_t limitBytes); // While enabled; 0 is ignored
+    TextStoreStats getStats();
+
+    std::shared_ptr<EventText> make(std::string title, std::string description);
+    // The text, read in place where it can't move and otherwise copied into
+    // copy (reading it back from the spill file if need be)
+    const std::string& title(EventText& text, std::string& copy);
+    const std::string& description(EventText& text, std::string& copy);
+    void release(EventText& text); // From ~EventText
+};
+
+#endif
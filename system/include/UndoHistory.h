@@ -0,0 +1,27 @@
+#ifndef UNDOHISTORY_H
+#define UNDOHISTORY_H
+
+#include "EventManager.h"
+#include <vector>
+
+// Undo/redo over EventManager snapshots. Each step is a whole-store version
+// that shares structure with its neighbours, so keeping many is cheap and
+// switching between them only touches the events that differ.
+class UndoHistory {
+private:
+    std::vector<PersistentEventMap> undoStack;
+    std::vector<PersistentEventMap> redoStack;
+    size_t limit;
+
+public:
+    explicit UndoHistory(size_t limit = 100);
+
+    void record(const PersistentEventMap& before); // Call after a change; clears redo
+    bool undo(EventManager& manager);
+    bool redo(EventManager& manager);
+    bool canUndo() const { return !undoStack.empty(); }
+    bool canRedo() const { return !redoStack.empty(); }
+    void clear();
+};
+
+#endif
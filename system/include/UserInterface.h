@@ -3,12 +3,25 @@
 
 #include "EventManager.h"
 #include "FileHandler.h"
+#include "EventRenderer.h"
+#include "ArchiveStore.h"
+#include "BackupStore.h"
+#include "UndoHistory.h"
+#include "SnapshotWriter.h"
+#include "CalendarRegistry.h"
 #include <string>
+#include <vector>
 
 class UserInterface {
 private:
-    EventManager eventManager;
-    FileHandler fileHandler;
+    static const int DEFAULT_COMMIT_DELAY_MS = 100; // Changes this close together share a save
+    static const int CALENDAR_IDLE_SECONDS = 600;   // Unused calendars are unloaded after this
+    
+    CalendarRegistry calendars;
+    Calendar* active; // The calendar menu actions work on
+    bool outsideChanges; // A calendar changed outside undo (another shared instance, archiving) since the last menu choice
+    ArchivePolicy archivePolicy;
+    SnapshotWriter writer; // Saves in the background; declared last so it finishes first
     
     // Helper methods
     void displayMenu();
@@ -16,8 +29,18 @@ private:
     void pauseScreen();
     std::time_t getDateTimeInput();
     int getPriorityInput();
+    RecurrenceRule getRecurrenceInput();
+    std::time_t getDurationInput();
     std::string getStringInput(const std::string& prompt);
     int getIntInput(const std::string& prompt);
+    RenderFormat getFormatInput();
+    void showPaged(const std::string& heading, const EventFilter& filter, RenderFormat format);
+    size_t archiveOldEvents();
+    void saveChanges(); // Every loaded calendar with changes; shared ones also take in the others'
+    void compactShared(Calendar& calendar); // Writes a shared calendar's data file
+    void openCalendar(const std::string& name); // Loads it on first use and makes it current
+    void addMerged(EventRenderer& renderer, const std::vector<CalendarEvent>& events);
+    void warnConflicts(const Event& event, int excludeId);
     
     // Menu handlers
     void handleAddEvent();
@@ -28,12 +51,15 @@ private:
     void handleMarkCompleted();
     void handleReminders();
     void handleSettings();
+    void handleArchive();
+    void handleUndoRedo(bool redo);
+    void handleCalendars();
     
 public:
-    UserInterface();
+    explicit UserInterface(bool shared = false); // Shared: alongside other instances on the same files
     void run();
     void showWelcome();
-    void showGoodbye();
+    void showGoodbye(bool saved);
 };
 
 #endif
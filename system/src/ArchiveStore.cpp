@@ -0,0 +1,177 @@
+#include "../include/ArchiveStore.h"
+#include "../include/Compression.h"
+#include "../include/FileSync.h"
+#include <fstream>
+#include <iostream>
+#include <cstring>
+
+namespace {
+
+const char FRAME_MAGIC[4] = {'E', 'V', 'A', 'R'};
+
+template <typename T>
+void writeField(std::ostream& out, T value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+void writeField(std::string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+bool readField(std::istream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+} // namespace
+
+bool ArchivePolicy::shouldArchive(const Event& event, std::time_t now) const {
+    if (event.getIsCompleted()) return archiveCompleted;
+    // A pending series is still active however old its next occurrence is
+    if (event.isRecurring() || maxAgeDays <= 0) return false;
+    return event.getEventTime() < now - static_cast<std::time_t>(maxAgeDays) * 86400;
+}
+
+ArchiveStore::ArchiveStore(const std::string& filename) : filename(filename), syncWrites(true) {}
+
+bool ArchiveStore::append(const std::vector<Event>& events, std::time_t archivedAt) {
+    if (events.empty()) return true;
+
+    std::string raw;
+    int maxId = 0;
+    for (const Event& event : events) {
+        std::string serialized = event.serialize();
+        writeField(raw, static_cast<uint32_t>(serialized.size()));
+        raw += serialized;
+        if (event.getId() > maxId) maxId = event.getId();
+    }
+
+    std::string stored;
+    Compression::compress(raw.data(), raw.size(), stored);
+
+    std::ofstream file(filename, std::ios::binary | std::ios::app);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open archive for writing: " << filename << std::endl;
+        return false;
+    }
+
+    file.write(FRAME_MAGIC, sizeof(FRAME_MAGIC));
+    writeField(file, static_cast<uint32_t>(events.size()));
+    writeField(file, static_cast<uint32_t>(raw.size()));
+    writeField(file, static_cast<uint32_t>(stored.size()));
+    writeField(file, static_cast<int32_t>(maxId));
+    writeField(file, static_cast<int64_t>(archivedAt));
+    file.write(stored.data(), stored.size());
+    file.close();
+
+    if (!file) {
+        std::cerr << "Error: Failed to write archive frame: " << filename << std::endl;
+        return false;
+    }
+    // The hot file is saved with a sync next, so the frame must not be the
+    // part a power loss takes; the first frame also creates the file
+    if (syncWrites && (!FileSync::syncFile(filename) || !FileSync::syncParent(filename))) {
+        std::cerr << "Error: Could not flush archive to disk: " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+size_t ArchiveStore::archive(EventManager& manager, const ArchivePolicy& policy) {
+    std::time_t now = manager.getClock().now();
+    std::vector<Event> moved = manager.extractEvents(
+        [&policy, now](const Event& event) { return policy.shouldArchive(event, now); });
+
+    // The archive is written before the caller saves the hot file, so a
+    // crash in between duplicates events rather than losing them
+    if (!append(moved, now)) {
+        manager.addEvents(moved);
+        return 0;
+    }
+    return moved.size();
+}
+
+bool ArchiveStore::scanFrames(const std::function<void(const FrameHeader&)>& header,
+                              const std::function<bool(const Event&)>& visit) const {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) return true; // Nothing archived yet
+
+    std::string stored;
+    std::string raw;
+    while (true) {
+        FrameHeader frame;
+        if (!file.read(frame.magic, sizeof(frame.magic))) return true; // Clean end of file
+
+        if (std::memcmp(frame.magic, FRAME_MAGIC, sizeof(FRAME_MAGIC)) != 0 ||
+            !readField(file, frame.recordCount) || !readField(file, frame.rawSize) ||
+            !readField(file, frame.storedSize) || !readField(file, frame.maxId) ||
+            !readField(file, frame.archivedAt)) {
+            std::cerr << "Error: Corrupt archive frame header in " << filename << std::endl;
+            return false;
+        }
+
+        if (header) header(frame);
+
+        if (!visit) {
+            file.seekg(frame.storedSize, std::ios::cur);
+            continue;
+        }
+
+        stored.resize(frame.storedSize);
+        raw.clear();
+        if (!file.read(&stored[0], frame.storedSize) ||
+            !Compression::decompress(stored.data(), stored.size(), frame.rawSize, raw)) {
+            std::cerr << "Error: Corrupt archive frame in " << filename << std::endl;
+            return false;
+        }
+
+        size_t pos = 0;
+        for (uint32_t i = 0; i < frame.recordCount; ++i) {
+            uint32_t length;
+            if (raw.size() - pos < sizeof(length)) return false;
+            std::memcpy(&length, raw.data() + pos, sizeof(length));
+            pos += sizeof(length);
+            if (raw.size() - pos < length) return false;
+
+            Event event = Event::deserialize(raw.substr(pos, length));
+            pos += length;
+            if (!visit(event)) return true;
+        }
+    }
+}
+
+bool ArchiveStore::forEach(const std::function<bool(const Event&)>& visit) const {
+    try {
+        return scanFrames(std::function<void(const FrameHeader&)>(), visit);
+    } catch (const std::exception& e) {
+        std::cerr << "Error reading archive: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+std::vector<Event> ArchiveStore::searchByTitle(const std::string& title) const {
+    std::vector<Event> results;
+    forEach([&results, &title](const Event& event) {
+        if (event.getTitle().find(title) != std::string::npos) {
+            results.push_back(event);
+        }
+        return true;
+    });
+    return results;
+}
+
+bool ArchiveStore::getStats(ArchiveStats& stats) const {
+    stats = ArchiveStats();
+    return scanFrames([&stats](const FrameHeader& frame) {
+        stats.frames++;
+        stats.events += frame.recordCount;
+        stats.rawBytes += frame.rawSize;
+        stats.storedBytes += frame.storedSize;
+    }, std::function<bool(const Event&)>());
+}
+
+void ArchiveStore::reserveIds() const {
+    scanFrames([](const FrameHeader& frame) { Event::reserveIds(frame.maxId); },
+               std::function<bool(const Event&)>());
+}
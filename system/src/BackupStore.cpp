@@ -0,0 +1,425 @@
+#include "../include/BackupStore.h"
+#include "../include/FileSync.h"
+#include <fstream>
+#include <iostream>
+#include <cstring>
+#include <cstdio>
+#include <array>
+
+#ifdef __linux__
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/syscall.h>
+#include <cerrno>
+#endif
+
+namespace {
+
+const char GENERATION_MAGIC[4] = {'E', 'V', 'B', 'K'};
+const size_t INDEX_RECORD_SIZE = 8 + 8 + 8 + 4;
+
+// Chunk sizes: cut points are content-defined but never closer than
+// MIN_CHUNK or further apart than MAX_CHUNK; the mask gives ~8KB on average
+const size_t MIN_CHUNK = 2048;
+const size_t MAX_CHUNK = 65536;
+const uint64_t BOUNDARY_MASK = ((1ull << 13) - 1) << (64 - 13);
+
+template <typename T>
+void writeField(std::string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+bool readField(const std::string& in, size_t& pos, T& value) {
+    if (in.size() - pos < sizeof(value)) return false;
+    std::memcpy(&value, in.data() + pos, sizeof(value));
+    pos += sizeof(value);
+    return true;
+}
+
+bool readFile(const std::string& path, std::string& out) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) return false;
+    std::streamoff size = file.tellg();
+    out.assign(static_cast<size_t>(size > 0 ? size : 0), '\0');
+    file.seekg(0);
+    return out.empty() || static_cast<bool>(file.read(&out[0], size));
+}
+
+uint64_t fileSize(const std::string& path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) return 0;
+    std::streamoff size = file.tellg();
+    return size > 0 ? static_cast<uint64_t>(size) : 0;
+}
+
+bool appendFile(const std::string& path, const std::string& bytes) {
+    std::ofstream file(path, std::ios::binary | std::ios::app);
+    file.write(bytes.data(), bytes.size());
+    file.flush();
+    return static_cast<bool>(file);
+}
+
+// Drops a torn record left at the end of a file by an interrupted backup
+void truncateFile(const std::string& path, const std::string& content, size_t validBytes) {
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(content.data(), validBytes);
+    }
+    FileSync::syncFile(path); // Later records are appended after the cut
+}
+
+inline uint64_t rotl(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+inline uint64_t avalanche(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ull;
+    x ^= x >> 33;
+    return x;
+}
+
+// Random per-byte values for the rolling gear hash; built once, thread-safely
+const uint64_t* gearTable() {
+    static const std::array<uint64_t, 256> table = [] {
+        std::array<uint64_t, 256> values;
+        uint64_t state = 0x2545f4914f6cdd1dull;
+        for (uint64_t& entry : values) {
+            state += 0x9e3779b97f4a7c15ull; // splitmix64
+            entry = avalanche(state);
+        }
+        return values;
+    }();
+    return table.data();
+}
+
+// Length of the next chunk. Shifting the gear hash left ages bytes out after
+// 64 steps, and testing its top bits makes the cut depend on that window only.
+size_t nextCut(const unsigned char* data, size_t length, const uint64_t* gear) {
+    if (length <= MIN_CHUNK) return length;
+    size_t limit = length < MAX_CHUNK ? length : MAX_CHUNK;
+    uint64_t hash = 0;
+    for (size_t i = MIN_CHUNK; i < limit; ++i) {
+        hash = (hash << 1) + gear[data[i]];
+        if ((hash & BOUNDARY_MASK) == 0) return i + 1;
+    }
+    return limit;
+}
+
+// 128-bit content hash; two lanes so a collision needs both to collide
+void hashChunk(const char* data, size_t length, uint64_t& low, uint64_t& high) {
+    uint64_t a = 0x9e3779b97f4a7c15ull ^ length;
+    uint64_t b = 0xc2b2ae3d27d4eb4full + length;
+    size_t i = 0;
+    for (; i + 8 <= length; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, 8);
+        a = rotl(a ^ (word * 0x87c37b91114253d5ull), 31) * 0x4cf5ad432745937full;
+        b = (rotl(b + (word * 0x52dce729ull), 29) * 0x38495ab5ull) ^ a;
+    }
+    uint64_t tail = 0;
+    std::memcpy(&tail, data + i, length - i);
+    a ^= tail * 0x87c37b91114253d5ull;
+    b += tail * 0x52dce729ull;
+    low = avalanche(a ^ rotl(b, 17));
+    high = avalanche(b + a);
+}
+
+#ifdef __linux__
+// Copies [offset, offset + length) of in to the current end of out. The
+// kernel moves (or reflinks) the data itself; read/write is the fallback
+// where copy_file_range is missing or can't cross these filesystems.
+bool copyRange(int in, uint64_t offset, uint64_t length, int out) {
+    loff_t from = static_cast<loff_t>(offset);
+#ifdef __NR_copy_file_range
+    while (length > 0) {
+        long copied = syscall(__NR_copy_file_range, in, &from, out, nullptr,
+                              static_cast<size_t>(length), 0u);
+        if (copied > 0) {
+            length -= static_cast<uint64_t>(copied);
+            continue;
+        }
+        if (copied == 0) return false; // Source shorter than the index says
+        if (errno == EINTR) continue;
+        if (errno != ENOSYS && errno != EXDEV && errno != EINVAL && errno != EOPNOTSUPP) return false;
+        break;
+    }
+#endif
+    char buffer[65536];
+    while (length > 0) {
+        size_t want = length < sizeof(buffer) ? static_cast<size_t>(length) : sizeof(buffer);
+        ssize_t got = ::pread(in, buffer, want, from);
+        if (got <= 0) return false;
+        for (ssize_t done = 0; done < got;) {
+            ssize_t wrote = ::write(out, buffer + done, static_cast<size_t>(got - done));
+            if (wrote <= 0) return false;
+            done += wrote;
+        }
+        from += got;
+        length -= static_cast<uint64_t>(got);
+    }
+    return true;
+}
+#endif
+
+} // namespace
+
+BackupStore::BackupStore(const std::string& dataFile)
+    : dataFile(dataFile), packFile(dataFile + ".backup.pack"), indexFile(dataFile + ".backup.index"),
+      logFile(dataFile + ".backup.log"), loaded(false), syncWrites(true) {}
+
+bool BackupStore::load() {
+    if (loaded) return true;
+    chunks.clear();
+    byHash.clear();
+    generations.clear();
+
+    // Index entries are only trusted if the pack actually holds their bytes
+    std::string index;
+    readFile(indexFile, index);
+    uint64_t packSize = fileSize(packFile);
+    size_t pos = 0;
+    while (index.size() - pos >= INDEX_RECORD_SIZE) {
+        Chunk chunk = {};
+        size_t start = pos;
+        readField(index, pos, chunk.hashLow);
+        readField(index, pos, chunk.hashHigh);
+        readField(index, pos, chunk.offset);
+        readField(index, pos, chunk.length);
+        if (chunk.offset + chunk.length > packSize) {
+            pos = start;
+            break;
+        }
+        byHash.emplace(chunk.hashLow, static_cast<uint32_t>(chunks.size()));
+        chunks.push_back(chunk);
+    }
+    if (pos != index.size()) truncateFile(indexFile, index, pos);
+
+    // The log record is written last, so a generation exists only once whole
+    std::string log;
+    readFile(logFile, log);
+    pos = 0;
+    while (pos < log.size()) {
+        size_t start = pos;
+        char magic[4] = {};
+        BackupGeneration generation;
+        int32_t id = 0;
+        int64_t createdAt = 0;
+        uint32_t count = 0;
+        bool valid = log.size() - pos >= sizeof(magic);
+        if (valid) {
+            std::memcpy(magic, log.data() + pos, sizeof(magic));
+            pos += sizeof(magic);
+            valid = std::memcmp(magic, GENERATION_MAGIC, sizeof(magic)) == 0 &&
+                    readField(log, pos, id) && readField(log, pos, createdAt) &&
+                    readField(log, pos, generation.size) && readField(log, pos, generation.newBytes) &&
+                    readField(log, pos, count) && (log.size() - pos) / sizeof(uint32_t) >= count;
+        }
+        for (uint32_t i = 0; valid && i < count; ++i) {
+            uint32_t chunk = 0;
+            readField(log, pos, chunk);
+            valid = chunk < chunks.size();
+            generation.chunks.push_back(chunk);
+        }
+        if (!valid) {
+            std::cerr << "Warning: Ignoring damaged backup log tail in " << logFile << std::endl;
+            truncateFile(logFile, log, start);
+            break;
+        }
+        generation.id = id;
+        generation.createdAt = static_cast<std::time_t>(createdAt);
+        generations.push_back(generation);
+    }
+
+    loaded = true;
+    return true;
+}
+
+int BackupStore::findChunk(uint64_t hashLow, uint64_t hashHigh, uint32_t length) const {
+    auto range = byHash.equal_range(hashLow);
+    for (auto it = range.first; it != range.second; ++it) {
+        const Chunk& chunk = chunks[it->second];
+        if (chunk.hashHigh == hashHigh && chunk.length == length) return static_cast<int>(it->second);
+    }
+    return -1;
+}
+
+bool BackupStore::appendChunks(const std::string& data, const std::vector<Chunk>& fresh) {
+    // fresh[i].offset is still the offset in data; consecutive chunks are
+    // usually adjacent there too, so they go out as one write
+    std::ofstream pack(packFile, std::ios::binary | std::ios::app);
+    for (size_t i = 0; i < fresh.size();) {
+        uint64_t start = fresh[i].offset;
+        uint64_t end = start + fresh[i].length;
+        for (++i; i < fresh.size() && fresh[i].offset == end; ++i) {
+            end += fresh[i].length;
+        }
+        pack.write(data.data() + start, static_cast<std::streamsize>(end - start));
+    }
+    pack.flush();
+    return static_cast<bool>(pack);
+}
+
+bool BackupStore::writeIndex(const std::vector<Chunk>& fresh) {
+    std::string records;
+    for (const Chunk& chunk : fresh) {
+        writeField(records, chunk.hashLow);
+        writeField(records, chunk.hashHigh);
+        writeField(records, chunk.offset);
+        writeField(records, chunk.length);
+    }
+    return appendFile(indexFile, records);
+}
+
+bool BackupStore::writeGeneration(const BackupGeneration& generation) {
+    std::string record(GENERATION_MAGIC, sizeof(GENERATION_MAGIC));
+    writeField(record, static_cast<int32_t>(generation.id));
+    writeField(record, static_cast<int64_t>(generation.createdAt));
+    writeField(record, generation.size);
+    writeField(record, generation.newBytes);
+    writeField(record, static_cast<uint32_t>(generation.chunks.size()));
+    for (uint32_t chunk : generation.chunks) {
+        writeField(record, chunk);
+    }
+    return appendFile(logFile, record);
+}
+
+int BackupStore::create(std::time_t now) {
+    load();
+
+    std::string data;
+    if (!readFile(dataFile, data)) {
+        std::cerr << "Error: Could not read data file for backup: " << dataFile << std::endl;
+        return 0;
+    }
+
+    BackupGeneration generation;
+    generation.id = generations.empty() ? 1 : generations.back().id + 1;
+    generation.createdAt = now;
+    generation.size = data.size();
+
+    // Register new chunks right away so repeats within this file dedup too
+    std::vector<Chunk> fresh;
+    size_t firstFresh = chunks.size();
+    uint64_t packEnd = fileSize(packFile);
+    const uint64_t* gear = gearTable();
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data.data());
+    for (size_t offset = 0; offset < data.size();) {
+        size_t length = nextCut(bytes + offset, data.size() - offset, gear);
+        Chunk chunk = {};
+        hashChunk(data.data() + offset, length, chunk.hashLow, chunk.hashHigh);
+        chunk.length = static_cast<uint32_t>(length);
+        int existing = findChunk(chunk.hashLow, chunk.hashHigh, chunk.length);
+        if (existing < 0) {
+            existing = static_cast<int>(chunks.size());
+            chunk.offset = offset;
+            fresh.push_back(chunk);
+            chunk.offset = packEnd + generation.newBytes;
+            generation.newBytes += length;
+            byHash.emplace(chunk.hashLow, static_cast<uint32_t>(existing));
+            chunks.push_back(chunk);
+        }
+        generation.chunks.push_back(static_cast<uint32_t>(existing));
+        offset += length;
+    }
+
+    // Pack, then index, then log: a crash at any point leaves the earlier
+    // generations intact and at worst some unreferenced bytes in the pack.
+    // The log record may only reach the disk after the chunks it names.
+    bool written = appendChunks(data, fresh);
+    if (written) {
+        for (size_t i = 0; i < fresh.size(); ++i) {
+            fresh[i].offset = chunks[firstFresh + i].offset;
+        }
+        written = writeIndex(fresh);
+    }
+    if (written && syncWrites) {
+        written = FileSync::syncFile(packFile) && FileSync::syncFile(indexFile) && FileSync::syncParent(packFile);
+    }
+    if (written) written = writeGeneration(generation);
+    if (written && syncWrites) written = FileSync::syncFile(logFile) && FileSync::syncParent(logFile);
+    if (!written) {
+        std::cerr << "Error: Failed to write backup for " << dataFile << std::endl;
+        loaded = false; // Reload from disk rather than trust the half-added chunks
+        return 0;
+    }
+
+    generations.push_back(generation);
+    return generation.id;
+}
+
+bool BackupStore::copyOut(const BackupGeneration& generation, const std::string& target) const {
+#ifdef __linux__
+    int in = ::open(packFile.c_str(), O_RDONLY);
+    int out = ::open(target.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    bool copied = in >= 0 && out >= 0;
+#else
+    std::ifstream in(packFile, std::ios::binary);
+    std::ofstream out(target, std::ios::binary | std::ios::trunc);
+    bool copied = in.is_open() && out.is_open();
+    std::string buffer;
+#endif
+
+    // Chunks stored back to back in the pack are copied as one range, so the
+    // first generation restores as a single copy
+    for (size_t i = 0; copied && i < generation.chunks.size();) {
+        const Chunk& first = chunks[generation.chunks[i]];
+        uint64_t start = first.offset;
+        uint64_t end = start + first.length;
+        for (++i; i < generation.chunks.size() && chunks[generation.chunks[i]].offset == end; ++i) {
+            end += chunks[generation.chunks[i]].length;
+        }
+#ifdef __linux__
+        copied = copyRange(in, start, end - start, out);
+#else
+        buffer.resize(static_cast<size_t>(end - start));
+        in.seekg(static_cast<std::streamoff>(start));
+        copied = in.read(&buffer[0], static_cast<std::streamsize>(buffer.size())) &&
+                 out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+#endif
+    }
+
+#ifdef __linux__
+    if (in >= 0) ::close(in);
+    if (out >= 0 && ::close(out) != 0) copied = false;
+#endif
+    return copied;
+}
+
+bool BackupStore::restore(int generation) {
+    load();
+    const BackupGeneration* source = nullptr;
+    for (const BackupGeneration& candidate : generations) {
+        if (generation == 0 || candidate.id == generation) source = &candidate;
+    }
+    if (source == nullptr) {
+        std::cerr << "Error: No backup generation " << generation << " for " << dataFile << std::endl;
+        return false;
+    }
+
+    // Build the file beside the data file and swap it in only when complete
+    std::string temp = dataFile + ".restore";
+    if (!copyOut(*source, temp) || fileSize(temp) != source->size ||
+        (syncWrites && !FileSync::syncFile(temp))) {
+        std::cerr << "Error: Could not restore backup generation " << source->id << std::endl;
+        std::remove(temp.c_str());
+        return false;
+    }
+    if (!FileSync::replaceFile(temp, dataFile, syncWrites)) {
+        std::cerr << "Error: Could not replace data file: " << dataFile << std::endl;
+        return false;
+    }
+    return true;
+}
+
+const std::vector<BackupGeneration>& BackupStore::list() {
+    load();
+    return generations;
+}
+
+uint64_t BackupStore::getPackBytes() {
+    return fileSize(packFile);
+}
@@ -0,0 +1,388 @@
+#include "../include/BatchProcessor.h"
+#include "../include/ArchiveStore.h"
+#include <iostream>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+const size_t OUTPUT_FLUSH_BYTES = 256 * 1024;
+
+std::vector<std::string> splitFields(const std::string& args) {
+    std::vector<std::string> fields;
+    size_t start = 0;
+    while (true) {
+        size_t bar = args.find('|', start);
+        if (bar == std::string::npos) {
+            fields.push_back(args.substr(start));
+            return fields;
+        }
+        fields.push_back(args.substr(start, bar - start));
+        start = bar + 1;
+    }
+}
+
+bool parseInt(const std::string& text, long long& value) {
+    if (text.empty()) return false;
+    char* end = nullptr;
+    value = std::strtoll(text.c_str(), &end, 10);
+    return end != nullptr && *end == '\0';
+}
+
+// "YYYY-MM-DD HH:MM" in local time, or plain epoch seconds
+bool parseTime(const std::string& text, std::time_t& time) {
+    long long epoch;
+    if (parseInt(text, epoch)) {
+        time = static_cast<std::time_t>(epoch);
+        return true;
+    }
+
+    std::tm timeinfo = {};
+    int year, month, day, hour = 0, minute = 0;
+    int matched = std::sscanf(text.c_str(), "%d-%d-%d %d:%d", &year, &month, &day, &hour, &minute);
+    if (matched != 3 && matched != 5) return false;
+
+    timeinfo.tm_year = year - 1900;
+    timeinfo.tm_mon = month - 1;
+    timeinfo.tm_mday = day;
+    timeinfo.tm_hour = hour;
+    timeinfo.tm_min = minute;
+    timeinfo.tm_isdst = -1;
+    time = std::mktime(&timeinfo);
+    return time != static_cast<std::time_t>(-1);
+}
+
+// "HH:MM-HH:MM" working hours, optionally followed by " weekdays"
+bool parseWorkingHours(const std::string& text, WorkingHours& hours) {
+    int startHour, startMinute, endHour, endMinute;
+    char suffix[16] = "";
+    int matched = std::sscanf(text.c_str(), "%d:%d-%d:%d %15s", &startHour, &startMinute,
+                              &endHour, &endMinute, suffix);
+    if (matched < 4 || (matched == 5 && std::string(suffix) != "weekdays")) return false;
+
+    hours.enabled = true;
+    hours.startMinute = startHour * 60 + startMinute;
+    hours.endMinute = endHour * 60 + endMinute;
+    hours.weekdaysOnly = matched == 5;
+    return hours.startMinute >= 0 && hours.startMinute < hours.endMinute && hours.endMinute <= 24 * 60;
+}
+
+std::string formatTime(std::time_t time) {
+    char buffer[20];
+    std::tm* timeinfo = std::localtime(&time);
+    if (timeinfo == nullptr || std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M", timeinfo) == 0) {
+        return std::to_string(static_cast<long long>(time));
+    }
+    return buffer;
+}
+
+bool parsePriority(const std::string& text, int& priority) {
+    long long value;
+    if (!parseInt(text, value) || value < 1 || value > 3) return false;
+    priority = static_cast<int>(value);
+    return true;
+}
+
+} // namespace
+
+BatchProcessor::BatchProcessor(EventManager& manager, const BatchConfig& config)
+    : config(config), manager(manager), fileHandler(config.dataFile),
+      output(RenderFormat::Compact, manager.getClock().now()),
+      lineNumber(0), mutationsSinceSave(0), commandCount(0), errorCount(0) {
+    if (config.compress) fileHandler.setCompressed(true);
+    fileHandler.setSyncWrites(config.sync);
+}
+
+bool BatchProcessor::loadData() {
+    ArchiveStore(ArchiveStore::forDataFile(config.dataFile)).reserveIds();
+    if (!config.shared) return fileHandler.loadEvents(manager);
+    journal.reset(new SharedJournal(fileHandler, manager));
+    return journal->open() && journal->load([this]() { return fileHandler.loadEvents(manager); });
+}
+
+void BatchProcessor::error(const std::string& message) {
+    output.line("ERR " + std::to_string(lineNumber) + ": " + message);
+    errorCount++;
+}
+
+void BatchProcessor::mutated() {
+    mutationsSinceSave++;
+    if (config.checkpointEvery > 0 && mutationsSinceSave >= config.checkpointEvery) {
+        checkpoint();
+    }
+}
+
+bool BatchProcessor::checkpoint(bool force) {
+    if (!config.save || (!force && mutationsSinceSave == 0)) return true;
+    // In shared mode this also folds the other instances' changes into the file
+    if (!(journal ? journal->compact() : fileHandler.saveEvents(manager))) {
+        error("could not save " + config.dataFile);
+        return false;
+    }
+    mutationsSinceSave = 0;
+    return true;
+}
+
+void BatchProcessor::listResults(const std::vector<Event>& events) {
+    output.beginTable();
+    for (const Event& event : events) {
+        output.add(event);
+    }
+    output.line("OK " + std::to_string(events.size()));
+}
+
+bool BatchProcessor::execute(const std::string& command, const std::string& args) {
+    if (command == "add") {
+        std::vector<std::string> fields = splitFields(args);
+        std::time_t eventTime;
+        int priority = 2;
+        if (fields.size() < 3 || fields[0].empty()) {
+            error("usage: add <title>|<description>|<time>|<priority>|<repeat>|<minutes>");
+            return false;
+        }
+        if (!parseTime(fields[2], eventTime)) {
+            error("invalid time '" + fields[2] + "'");
+            return false;
+        }
+        if (fields.size() > 3 && !parsePriority(fields[3], priority)) {
+            error("invalid priority '" + fields[3] + "'");
+            return false;
+        }
+        RecurrenceRule recurrence;
+        if (fields.size() > 4 && !fields[4].empty() && !RecurrenceRule::parse(fields[4], recurrence)) {
+            error("invalid repeat rule '" + fields[4] + "'");
+            return false;
+        }
+        long long minutes = 0;
+        if (fields.size() > 5 && !fields[5].empty() && (!parseInt(fields[5], minutes) || minutes < 0)) {
+            error("invalid duration '" + fields[5] + "'");
+            return false;
+        }
+        Event event(fields[0], fields[1], eventTime, priority);
+        event.setRecurrence(recurrence);
+        event.setDuration(static_cast<std::time_t>(minutes) * 60);
+        manager.addEvent(event);
+        output.line("OK " + std::to_string(event.getId()));
+        mutated();
+        return true;
+    }
+
+    if (command == "update") {
+        std::vector<std::string> fields = splitFields(args);
+        long long id;
+        if (fields.size() < 2 || !parseInt(fields[0], id)) {
+            error("usage: update <id>|<title>|<description>|<time>|<priority>");
+            return false;
+        }
+        EventHandle handle = manager.findEvent(static_cast<int>(id));
+        if (manager.getEvent(handle) == nullptr) {
+            error("event " + fields[0] + " not found");
+            return false;
+        }
+
+        // Empty fields keep their value
+        EventPatch patch;
+        patch.hasTitle = fields.size() > 1 && !fields[1].empty();
+        if (patch.hasTitle) patch.title = fields[1];
+        patch.hasDescription = fields.size() > 2 && !fields[2].empty();
+        if (patch.hasDescription) patch.description = fields[2];
+        patch.hasTime = fields.size() > 3 && !fields[3].empty();
+        if (patch.hasTime && !parseTime(fields[3], patch.eventTime)) {
+            error("invalid time '" + fields[3] + "'");
+            return false;
+        }
+        patch.hasPriority = fields.size() > 4 && !fields[4].empty();
+        if (patch.hasPriority && !parsePriority(fields[4], patch.priority)) {
+            error("invalid priority '" + fields[4] + "'");
+            return false;
+        }
+        manager.patchEvent(handle, patch);
+        output.line("OK " + fields[0]);
+        mutated();
+        return true;
+    }
+
+    if (command == "delete" || command == "complete" || command == "find") {
+        long long id;
+        if (!parseInt(args, id)) {
+            error("usage: " + command + " <id>");
+            return false;
+        }
+        EventHandle handle = manager.findEvent(static_cast<int>(id));
+        const Event* event = manager.getEvent(handle);
+        if (event == nullptr) {
+            error("event " + args + " not found");
+            return false;
+        }
+        if (command == "find") {
+            listResults(std::vector<Event>(1, *event));
+            return true;
+        }
+        if (command == "delete") {
+            manager.removeEvent(handle);
+        } else {
+            manager.markEventCompleted(handle);
+        }
+        output.line("OK " + args);
+        mutated();
+        return true;
+    }
+
+    if (command == "search") {
+        listResults(manager.searchByTitle(args));
+        return true;
+    }
+    if (command == "due") {
+        listResults(manager.getDueReminders());
+        return true;
+    }
+    if (command == "next") {
+        long long count = 10;
+        if (!args.empty() && (!parseInt(args, count) || count < 0)) {
+            error("usage: next [count]");
+            return false;
+        }
+        listResults(manager.nextTasks(static_cast<size_t>(count)));
+        return true;
+    }
+    if (command == "overlaps") {
+        std::vector<std::string> fields = splitFields(args);
+        std::time_t from;
+        std::time_t to;
+        if (fields.size() != 2 || !parseTime(fields[0], from) || !parseTime(fields[1], to)) {
+            error("usage: overlaps <from>|<to>");
+            return false;
+        }
+        listResults(manager.findOverlapping(from, to));
+        return true;
+    }
+    if (command == "free") {
+        std::vector<std::string> fields = splitFields(args);
+        std::time_t from;
+        std::time_t to;
+        long long minutes;
+        long long count = 10;
+        WorkingHours hours;
+        if (fields.size() < 3 || !parseTime(fields[0], from) || !parseTime(fields[1], to) ||
+            !parseInt(fields[2], minutes) || minutes < 1 ||
+            (fields.size() > 3 && !fields[3].empty() && (!parseInt(fields[3], count) || count < 0)) ||
+            (fields.size() > 4 && !fields[4].empty() && !parseWorkingHours(fields[4], hours))) {
+            error("usage: free <from>|<to>|<minutes>|<count>|<HH:MM-HH:MM [weekdays]>");
+            return false;
+        }
+        std::vector<TimeSlot> slots = manager.findFreeSlots(from, to, static_cast<std::time_t>(minutes) * 60,
+                                                            static_cast<size_t>(count), hours);
+        for (const TimeSlot& slot : slots) {
+            output.line(formatTime(slot.start) + " - " + formatTime(slot.end) + " (" +
+                        std::to_string(static_cast<long long>((slot.end - slot.start) / 60)) + " min)");
+        }
+        output.line("OK " + std::to_string(slots.size()));
+        return true;
+    }
+    if (command == "soonest") {
+        long long count = 10;
+        if (!args.empty() && (!parseInt(args, count) || count < 0)) {
+            error("usage: soonest [count]");
+            return false;
+        }
+        listResults(manager.nextEvents(static_cast<size_t>(count)));
+        return true;
+    }
+    if (command == "upcoming") {
+        long long hours = 24;
+        if (!args.empty() && !parseInt(args, hours)) {
+            error("usage: upcoming [hours]");
+            return false;
+        }
+        listResults(manager.getUpcomingReminders(static_cast<int>(hours)));
+        return true;
+    }
+    if (command == "list") {
+        listResults(manager.getAllEvents());
+        return true;
+    }
+    if (command == "count") {
+        output.line("OK " + std::to_string(manager.getEventCount()));
+        return true;
+    }
+    if (command == "changes") {
+        long long after = 0;
+        if (!args.empty() && (!parseInt(args, after) || after < 0)) {
+            error("usage: changes [after-sequence]");
+            return false;
+        }
+        static const char* typeNames[] = {"added", "updated", "removed", "completed", "cleared"};
+        std::vector<ChangeRecord> records;
+        bool complete = manager.getChangeFeed().poll(static_cast<uint64_t>(after), records);
+        for (const ChangeRecord& record : records) {
+            output.line(std::to_string(record.sequence) + " " + typeNames[static_cast<int>(record.type)] +
+                        " " + std::to_string(record.eventId));
+        }
+        output.line(std::string(complete ? "OK " : "OK (truncated) ") + std::to_string(records.size()));
+        return true;
+    }
+    if (command == "stats") {
+        EventStats stats = manager.getStats();
+        output.line("OK total=" + std::to_string(stats.total) +
+                    " pending=" + std::to_string(stats.pending) +
+                    " completed=" + std::to_string(stats.completed) +
+                    " due=" + std::to_string(stats.due) +
+                    " upcoming=" + std::to_string(stats.upcoming) +
+                    " high=" + std::to_string(stats.byPriority[0]) +
+                    " medium=" + std::to_string(stats.byPriority[1]) +
+                    " low=" + std::to_string(stats.byPriority[2]));
+        return true;
+    }
+    if (command == "save") {
+        if (!config.save) {
+            error("saving is disabled");
+            return false;
+        }
+        if (!checkpoint(true)) return false;
+        output.line("OK saved");
+        return true;
+    }
+
+    error("unknown command '" + command + "'");
+    return false;
+}
+
+bool BatchProcessor::run(std::istream& input) {
+    auto start = std::chrono::steady_clock::now();
+    std::string line;
+
+    while (std::getline(input, line)) {
+        lineNumber++;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+
+        size_t begin = line.find_first_not_of(" \t");
+        if (begin == std::string::npos || line[begin] == '#') continue;
+
+        size_t space = line.find(' ', begin);
+        std::string command = line.substr(begin, space == std::string::npos ? std::string::npos : space - begin);
+        std::string args = space == std::string::npos ? "" : line.substr(space + 1);
+
+        output.setNow(manager.getClock().now());
+        if (journal) journal->sync(); // Answer from the latest version
+        execute(command, args);
+        commandCount++;
+        if (journal) journal->sync(); // Publish right away, not when the next command arrives
+
+        if (output.size() >= OUTPUT_FLUSH_BYTES) {
+            output.flush();
+        }
+    }
+
+    checkpoint();
+    output.flush();
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << "Processed " << commandCount << " command(s) in " << seconds << " s";
+    if (seconds > 0.0) {
+        std::cerr << " (" << static_cast<long long>(commandCount / seconds) << " commands/s)";
+    }
+    std::cerr << ", " << errorCount << " error(s)" << std::endl;
+    return errorCount == 0;
+}
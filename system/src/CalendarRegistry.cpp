@@ -0,0 +1,175 @@
+#include "../include/CalendarRegistry.h"
+#include <filesystem>
+#include <algorithm>
+#include <iostream>
+#include <cctype>
+
+const char* const CalendarRegistry::DEFAULT_NAME = "default";
+
+namespace {
+
+const size_t MAX_NAME_LENGTH = 32;
+
+// "dir/events.dat" -> {"dir/events", ".dat"}
+void splitExtension(const std::string& path, std::string& stem, std::string& extension) {
+    size_t slash = path.find_last_of("/\\");
+    size_t dot = path.find_last_of('.');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        stem = path;
+        extension.clear();
+    } else {
+        stem = path.substr(0, dot);
+        extension = path.substr(dot);
+    }
+}
+
+} // namespace
+
+Calendar::Calendar(const std::string& name, const std::string& dataFile)
+    : name(name), file(dataFile), archive(ArchiveStore::forDataFile(dataFile)), unsaved(false), lastUsed(0) {
+    events.getChangeFeed().subscribe([this](const ChangeRecord&) { unsaved = true; });
+}
+
+CalendarRegistry::CalendarRegistry(const std::string& baseFile)
+    : baseFile(baseFile), syncWrites(true), shared(false) {}
+
+bool CalendarRegistry::isValidName(const std::string& name) {
+    if (name.empty() || name.size() > MAX_NAME_LENGTH) return false;
+    return std::all_of(name.begin(), name.end(), [](char c) {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '-' || c == '_';
+    });
+}
+
+std::string CalendarRegistry::pathFor(const std::string& name) const {
+    if (name == DEFAULT_NAME) return baseFile;
+    std::string stem, extension;
+    splitExtension(baseFile, stem, extension);
+    return stem + "." + name + extension;
+}
+
+std::vector<std::string> CalendarRegistry::names() const {
+    std::vector<std::string> found;
+    std::string stem, extension;
+    splitExtension(baseFile, stem, extension);
+    std::filesystem::path base(stem);
+    std::string prefix = base.filename().string() + ".";
+    std::filesystem::path directory = base.parent_path().empty() ? "." : base.parent_path();
+
+    // Only file names are read here, never the calendars themselves
+    std::error_code error;
+    for (std::filesystem::directory_iterator entry(directory, error), end; !error && entry != end;
+         entry.increment(error)) {
+        std::string file = entry->path().filename().string();
+        if (file.size() <= prefix.size() + extension.size() || file.compare(0, prefix.size(), prefix) != 0 ||
+            file.compare(file.size() - extension.size(), extension.size(), extension) != 0) {
+            continue;
+        }
+        std::string name = file.substr(prefix.size(), file.size() - prefix.size() - extension.size());
+        if (isValidName(name) && name != DEFAULT_NAME) found.push_back(name);
+    }
+    for (const auto& entry : loaded) {
+        if (entry.first != DEFAULT_NAME) found.push_back(entry.first);
+    }
+    std::sort(found.begin(), found.end());
+    found.erase(std::unique(found.begin(), found.end()), found.end());
+    found.insert(found.begin(), DEFAULT_NAME);
+    return found;
+}
+
+Calendar& CalendarRegistry::open(const std::string& name, std::time_t now, bool& opened) {
+    auto it = loaded.find(name);
+    opened = it == loaded.end();
+    if (opened) {
+        std::unique_ptr<Calendar> calendar(new Calendar(name, pathFor(name)));
+        calendar->file.setSyncWrites(syncWrites);
+        calendar->archive.setSyncWrites(syncWrites);
+        if (shared) {
+            calendar->shared.reset(new SharedJournal(calendar->file, calendar->events));
+            if (!calendar->shared->open()) {
+                std::cout << "Calendar '" << name << "' is not shared with other instances." << std::endl;
+                calendar->shared.reset();
+            }
+        }
+        load(*calendar);
+        calendar->archive.reserveIds();
+        it = loaded.emplace(name, std::move(calendar)).first;
+    }
+    it->second->lastUsed = now;
+    return *it->second;
+}
+
+void CalendarRegistry::load(Calendar& calendar) {
+    if (calendar.shared) {
+        calendar.shared->load([&calendar]() {
+            readFile(calendar);
+            return true;
+        });
+    } else {
+        readFile(calendar);
+    }
+}
+
+void CalendarRegistry::readFile(Calendar& calendar) {
+    if (calendar.file.loadEvents(calendar.events)) {
+        calendar.unsaved = false;
+        return;
+    }
+    // A damaged file must not be saved over as if it were empty: keep a copy,
+    // salvage what is readable and write that back as a clean file
+    std::cout << "The data file is damaged. Recovering readable events..." << std::endl;
+    calendar.unsaved = calendar.file.recoverEvents(calendar.events) && calendar.file.getLoadReport().loaded > 0;
+}
+
+std::vector<Calendar*> CalendarRegistry::getLoaded() const {
+    std::vector<Calendar*> calendars;
+    for (const auto& entry : loaded) {
+        calendars.push_back(entry.second.get());
+    }
+    return calendars;
+}
+
+size_t CalendarRegistry::evictIdle(std::time_t now, std::time_t idleSeconds, const Calendar* keep,
+                                   SnapshotWriter& writer) {
+    std::vector<decltype(loaded)::iterator> idle;
+    for (auto it = loaded.begin(); it != loaded.end(); ++it) {
+        Calendar& calendar = *it->second;
+        if (&calendar == keep || now - calendar.lastUsed < idleSeconds) continue;
+        if (calendar.shared) {
+            calendar.shared->sync(); // The journal keeps the changes until a compaction
+        } else if (calendar.unsaved) {
+            // The snapshot outlives the store, so the write can go on after unloading
+            writer.submit(calendar.file, calendar.events.snapshot());
+            calendar.unsaved = false;
+        }
+        idle.push_back(it);
+    }
+    // Reopening must find the file up to date; if a save failed, stay loaded
+    // so its changes are not replaced by the file's older contents
+    if (idle.empty() || !writer.flush()) return 0;
+    for (auto it : idle) {
+        loaded.erase(it);
+    }
+    return idle.size();
+}
+
+std::vector<CalendarEvent> CalendarRegistry::query(
+    const std::function<std::vector<Event>(const EventManager&)>& run) const {
+    std::vector<CalendarEvent> merged;
+    for (const auto& entry : loaded) {
+        for (Event& event : run(entry.second->events)) {
+            merged.push_back(CalendarEvent{entry.second.get(), std::move(event)});
+        }
+    }
+    // Stable, so each calendar's own order decides ties
+    std::stable_sort(merged.begin(), merged.end(),
+                     [](const CalendarEvent& a, const CalendarEvent& b) { return a.event < b.event; });
+    return merged;
+}
+
+void CalendarRegistry::setSyncWrites(bool sync) {
+    syncWrites = sync;
+    for (const auto& entry : loaded) {
+        entry.second->file.setSyncWrites(sync);
+        entry.second->archive.setSyncWrites(sync);
+    }
+}
@@ -0,0 +1,60 @@
+#include "../include/ChangeFeed.h"
+
+ChangeFeed::ChangeFeed(size_t capacity)
+    : capacity(capacity > 0 ? capacity : 1), lastSequence(0), nextObserverId(1) {}
+
+uint64_t ChangeFeed::publish(ChangeType type, int eventId, const Event& event) {
+    uint64_t sequence = ++lastSequence;
+    size_t slot = static_cast<size_t>((sequence - 1) % capacity);
+
+    // Slot is sequence modulo capacity, so the ring needs no head pointer
+    if (ring.size() < capacity) {
+        ring.push_back(ChangeRecord{sequence, type, eventId, event});
+    } else {
+        ChangeRecord& record = ring[slot];
+        record.sequence = sequence;
+        record.type = type;
+        record.eventId = eventId;
+        record.event = event; // Reuses the old record's string buffers
+    }
+
+    // Iterate by index: an observer may subscribe another while being notified
+    for (size_t i = 0; i < observers.size(); ++i) {
+        observers[i].second(ring[slot]);
+    }
+    return sequence;
+}
+
+int ChangeFeed::subscribe(const ChangeObserver& observer) {
+    observers.push_back(std::make_pair(nextObserverId, observer));
+    return nextObserverId++;
+}
+
+void ChangeFeed::unsubscribe(int handle) {
+    for (auto it = observers.begin(); it != observers.end(); ++it) {
+        if (it->first == handle) {
+            observers.erase(it);
+            return;
+        }
+    }
+}
+
+uint64_t ChangeFeed::getOldestSequence() const {
+    if (ring.empty()) return 0;
+    return lastSequence - ring.size() + 1;
+}
+
+bool ChangeFeed::poll(uint64_t after, std::vector<ChangeRecord>& out, size_t max) const {
+    uint64_t oldest = getOldestSequence();
+    bool complete = true;
+    if (oldest == 0) return true;
+    if (after + 1 < oldest) {
+        complete = false;
+        after = oldest - 1;
+    }
+
+    for (uint64_t sequence = after + 1; sequence <= lastSequence && max > 0; ++sequence, --max) {
+        out.push_back(ring[(sequence - 1) % capacity]);
+    }
+    return complete;
+}
@@ -0,0 +1,102 @@
+#include "../include/Checksum.h"
+#include <cstring>
+
+namespace Checksum {
+
+namespace {
+
+const uint32_t POLYNOMIAL = 0x82F63B78u; // Reflected Castagnoli polynomial
+
+struct Tables {
+    uint32_t entries[8][256];
+
+    Tables() {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc >> 1) ^ (POLYNOMIAL & (0u - (crc & 1u)));
+            }
+            entries[0][i] = crc;
+        }
+        // entries[k][i]: the CRC of byte i followed by k zero bytes
+        for (uint32_t i = 0; i < 256; ++i) {
+            for (int k = 1; k < 8; ++k) {
+                entries[k][i] = (entries[k - 1][i] >> 8) ^ entries[0][entries[k - 1][i] & 0xFF];
+            }
+        }
+    }
+};
+
+const Tables& tables() {
+    static const Tables instance;
+    return instance;
+}
+
+uint32_t crcSoftware(const unsigned char* p, size_t size, uint32_t crc) {
+    const Tables& t = tables();
+    while (size >= 8) {
+        uint32_t low;
+        uint32_t high;
+        std::memcpy(&low, p, 4);
+        std::memcpy(&high, p + 4, 4);
+        low ^= crc; // Little-endian word order, as on every platform we build for
+        crc = t.entries[7][low & 0xFF] ^ t.entries[6][(low >> 8) & 0xFF] ^
+              t.entries[5][(low >> 16) & 0xFF] ^ t.entries[4][low >> 24] ^
+              t.entries[3][high & 0xFF] ^ t.entries[2][(high >> 8) & 0xFF] ^
+              t.entries[1][(high >> 16) & 0xFF] ^ t.entries[0][high >> 24];
+        p += 8;
+        size -= 8;
+    }
+    while (size-- > 0) {
+        crc = (crc >> 8) ^ t.entries[0][(crc ^ *p++) & 0xFF];
+    }
+    return crc;
+}
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define CHECKSUM_HAVE_SSE42 1
+
+__attribute__((target("sse4.2")))
+uint32_t crcHardware(const unsigned char* p, size_t size, uint32_t crc) {
+    uint64_t wide = crc;
+    while (size >= 8) {
+        uint64_t word;
+        std::memcpy(&word, p, 8);
+        wide = __builtin_ia32_crc32di(wide, word);
+        p += 8;
+        size -= 8;
+    }
+    crc = static_cast<uint32_t>(wide);
+    while (size-- > 0) {
+        crc = __builtin_ia32_crc32qi(crc, *p++);
+    }
+    return crc;
+}
+
+bool detectHardware() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse4.2");
+}
+#endif
+
+} // namespace
+
+bool hardwareAccelerated() {
+#ifdef CHECKSUM_HAVE_SSE42
+    static const bool available = detectHardware();
+    return available;
+#else
+    return false;
+#endif
+}
+
+uint32_t crc32c(const void* data, size_t size, uint32_t crc) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    crc = ~crc;
+#ifdef CHECKSUM_HAVE_SSE42
+    if (hardwareAccelerated()) return ~crcHardware(p, size, crc);
+#endif
+    return ~crcSoftware(p, size, crc);
+}
+
+} // namespace Checksum
@@ -0,0 +1,155 @@
+#include "../include/Compression.h"
+#include <cstring>
+#include <cstdint>
+#include <vector>
+
+namespace Compression {
+
+namespace {
+
+const size_t MIN_MATCH = 4;
+const size_t LAST_LITERALS = 5;   // Input tail always emitted as literals
+const size_t MATCH_LIMIT = 12;    // No match may start this close to the end
+const size_t MAX_OFFSET = 65535;
+const int HASH_BITS = 14;
+
+inline uint32_t read32(const unsigned char* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline uint32_t hash(uint32_t sequence) {
+    return (sequence * 2654435761U) >> (32 - HASH_BITS);
+}
+
+void writeLength(std::string& out, size_t length) {
+    while (length >= 255) {
+        out.push_back(static_cast<char>(255));
+        length -= 255;
+    }
+    out.push_back(static_cast<char>(length));
+}
+
+void emitSequence(std::string& out, const unsigned char* literals, size_t literalLength,
+                  size_t offset, size_t matchLength) {
+    size_t matchCode = matchLength ? matchLength - MIN_MATCH : 0;
+    unsigned char token = static_cast<unsigned char>(
+        ((literalLength < 15 ? literalLength : 15) << 4) | (matchCode < 15 ? matchCode : 15));
+    out.push_back(static_cast<char>(token));
+
+    if (literalLength >= 15) writeLength(out, literalLength - 15);
+    out.append(reinterpret_cast<const char*>(literals), literalLength);
+
+    if (matchLength == 0) return; // Final literal-only sequence
+    out.push_back(static_cast<char>(offset & 0xFF));
+    out.push_back(static_cast<char>(offset >> 8));
+    if (matchCode >= 15) writeLength(out, matchCode - 15);
+}
+
+bool readLength(const unsigned char*& ip, const unsigned char* end, size_t& length) {
+    unsigned char byte;
+    do {
+        if (ip >= end) return false;
+        byte = *ip++;
+        length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+} // namespace
+
+size_t compressBound(size_t size) {
+    return size + size / 255 + 16;
+}
+
+void compress(const char* data, size_t size, std::string& out) {
+    const unsigned char* src = reinterpret_cast<const unsigned char*>(data);
+    out.reserve(out.size() + compressBound(size));
+
+    size_t anchor = 0;
+    if (size > MATCH_LIMIT) {
+        // Positions are stored +1 so zero means "empty slot"
+        std::vector<uint32_t> table(1u << HASH_BITS, 0);
+        size_t limit = size - MATCH_LIMIT;
+        size_t ip = 0;
+
+        while (ip < limit) {
+            uint32_t sequence = read32(src + ip);
+            uint32_t slot = hash(sequence);
+            size_t candidate = table[slot];
+            table[slot] = static_cast<uint32_t>(ip + 1);
+
+            if (candidate == 0 || ip - (candidate - 1) > MAX_OFFSET ||
+                read32(src + candidate - 1) != sequence) {
+                // Skip faster through incompressible stretches
+                ip += 1 + ((ip - anchor) >> 6);
+                continue;
+            }
+
+            size_t ref = candidate - 1;
+            size_t matchLength = MIN_MATCH;
+            size_t maxLength = size - LAST_LITERALS - ip;
+            while (matchLength < maxLength && src[ref + matchLength] == src[ip + matchLength]) {
+                ++matchLength;
+            }
+
+            emitSequence(out, src + anchor, ip - anchor, ip - ref, matchLength);
+            ip += matchLength;
+            anchor = ip;
+        }
+    }
+
+    emitSequence(out, src + anchor, size - anchor, 0, 0);
+}
+
+bool decompress(const char* data, size_t size, size_t rawSize, std::string& out) {
+    const unsigned char* ip = reinterpret_cast<const unsigned char*>(data);
+    const unsigned char* end = ip + size;
+    size_t base = out.size();
+    size_t target = base + rawSize;
+    out.resize(target);
+    char* dst = &out[0];
+    size_t op = base;
+
+    while (ip < end) {
+        unsigned char token = *ip++;
+
+        size_t literalLength = token >> 4;
+        if (literalLength == 15 && !readLength(ip, end, literalLength)) break;
+        if (literalLength > static_cast<size_t>(end - ip) || literalLength > target - op) break;
+        std::memcpy(dst + op, ip, literalLength);
+        ip += literalLength;
+        op += literalLength;
+
+        if (ip == end) {
+            // Last sequence carries literals only
+            if (op == target) return true;
+            break;
+        }
+
+        if (end - ip < 2) break;
+        size_t offset = ip[0] | (static_cast<size_t>(ip[1]) << 8);
+        ip += 2;
+        size_t matchLength = token & 0x0F;
+        if (matchLength == 15 && !readLength(ip, end, matchLength)) break;
+        matchLength += MIN_MATCH;
+
+        if (offset == 0 || offset > op - base || matchLength > target - op) break;
+        const char* match = dst + op - offset;
+        if (offset >= matchLength) {
+            std::memcpy(dst + op, match, matchLength);
+        } else {
+            // Overlapping match: byte copy repeats the most recent bytes
+            for (size_t i = 0; i < matchLength; ++i) {
+                dst[op + i] = match[i];
+            }
+        }
+        op += matchLength;
+    }
+
+    out.resize(base);
+    return false;
+}
+
+} // namespace Compression
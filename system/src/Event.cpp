@@ -2,14 +2,103 @@
 #include <sstream>
 #include <iomanip>
 
-int Event::nextId = 1;
+std::atomic<int> Event::nextId(1);
 
-Event::Event() : id(nextId++), title(""), description(""), eventTime(0), priority(2), isCompleted(false) {}
+namespace {
+
+// Shared by every event created without text
+const std::shared_ptr<EventText>& emptyText() {
+    static const std::shared_ptr<EventText> empty = std::make_shared<EventText>("", "", false);
+    return empty;
+}
+
+// Text fields may contain the '|' separator; it and the backslash are
+// written with a backslash in front
+void writeText(std::ostream& out, const std::string& text) {
+    size_t start = 0;
+    for (size_t i = text.find_first_of("|\\"); i != std::string::npos; i = text.find_first_of("|\\", i + 1)) {
+        out.write(text.data() + start, i - start);
+        out << '\\' << text[i];
+        start = i + 1;
+    }
+    out.write(text.data() + start, text.size() - start);
+}
+
+// Reads up to the next unescaped '|'. A backslash before anything else is
+// kept, as files written before escaping may contain one.
+void readText(std::istream& in, std::string& text) {
+    text.clear();
+    char c;
+    while (in.get(c) && c != '|') {
+        if (c == '\\' && (in.peek() == '|' || in.peek() == '\\')) in.get(c);
+        text += c;
+    }
+}
+
+} // namespace
+
+Event::Event() : Event(nextId++) {}
+
+Event::Event(int id) : id(id), text(emptyText()), eventTime(0), duration(0), priority(2), isCompleted(false),
+                       seriesStart(0), occurrenceIndex(0) {}
 
 Event::Event(const std::string& title, const std::string& description, 
              std::time_t eventTime, int priority) 
-    : id(nextId++), title(title), description(description), 
-      eventTime(eventTime), priority(priority), isCompleted(false) {}
+    : id(nextId++), text(TextStore::instance().make(title, description)), 
+      eventTime(eventTime), duration(0), priority(priority), isCompleted(false),
+      seriesStart(eventTime), occurrenceIndex(0) {}
+
+std::string Event::getTitle() const {
+    std::string copy;
+    return TextStore::instance().title(*text, copy);
+}
+
+std::string Event::getDescription() const {
+    std::string copy;
+    return TextStore::instance().description(*text, copy);
+}
+
+void Event::setTitle(const std::string& title) {
+    text = TextStore::instance().make(title, getDescription());
+}
+
+void Event::setDescription(const std::string& description) {
+    text = TextStore::instance().make(getTitle(), description);
+}
+
+void Event::setText(const std::string& title, const std::string& description) {
+    text = TextStore::instance().make(title, description);
+}
+
+void Event::setEventTime(std::time_t eventTime) {
+    this->eventTime = eventTime;
+    seriesStart = eventTime;
+    occurrenceIndex = 0;
+}
+
+void Event::setRecurrence(const RecurrenceRule& rule) {
+    recurrence = rule;
+    seriesStart = eventTime;
+    occurrenceIndex = 0;
+}
+
+bool Event::advanceOccurrence(std::time_t after) {
+    OccurrenceIterator it = occurrences();
+    it.next();
+    it.seek(after + 1); // Skip occurrences that already passed
+    if (!it.isValid()) return false;
+    
+    occurrenceIndex = it.getIndex();
+    eventTime = it.time();
+    return true;
+}
+
+Event Event::atOccurrence(const OccurrenceIterator& occurrence) const {
+    Event copy(*this);
+    copy.eventTime = occurrence.time();
+    copy.occurrenceIndex = occurrence.getIndex();
+    return copy;
+}
 
 std::string Event::getFormattedTime() const {
     std::tm* timeinfo = std::localtime(&eventTime);
@@ -27,13 +116,11 @@ std::string Event::getPriorityString() const {
     }
 }
 
-bool Event::isUpcoming() const {
-    std::time_t now = std::time(nullptr);
+bool Event::isUpcoming(std::time_t now) const {
     return eventTime > now && !isCompleted;
 }
 
-bool Event::isDue() const {
-    std::time_t now = std::time(nullptr);
+bool Event::isDue(std::time_t now) const {
     return eventTime <= now && !isCompleted;
 }
 
@@ -53,27 +140,65 @@ bool Event::operator==(const Event& other) const {
 }
 
 std::string Event::serialize() const {
+    std::string title, description;
     std::ostringstream oss;
-    oss << id << "|" << title << "|" << description << "|" 
-        << eventTime << "|" << priority << "|" << isCompleted;
+    oss << id << "|";
+    writeText(oss, TextStore::instance().title(*text, title));
+    oss << "|";
+    writeText(oss, TextStore::instance().description(*text, description));
+    oss << "|" << eventTime << "|" << priority << "|" << isCompleted;
+    
+    // Recurring events and events with a duration append their rule (and then
+    // the duration); older readers stop after the status
+    if (recurrence.isRecurring() || duration > 0) {
+        oss << "|" << recurrence.toString() << "|" << seriesStart << "|" << occurrenceIndex;
+    }
+    if (duration > 0) {
+        oss << "|" << duration;
+    }
     return oss.str();
 }
 
+void Event::reserveIds(int lastId) {
+    int current = nextId.load();
+    while (lastId >= current && !nextId.compare_exchange_weak(current, lastId + 1)) {
+        // current was reloaded; retry unless another thread already went past lastId
+    }
+}
+
+int Event::claimId() {
+    return nextId++;
+}
+
+const Event& Event::none() {
+    static const Event empty(0);
+    return empty;
+}
+
+Event Event::withId(int id) const {
+    Event copy(*this);
+    copy.id = id;
+    reserveIds(id);
+    return copy;
+}
+
 Event Event::deserialize(const std::string& data) {
     std::istringstream iss(data);
     std::string token;
-    Event event;
     
     // Parse ID
     std::getline(iss, token, '|');
-    event.id = std::stoi(token);
-    if (event.id >= nextId) nextId = event.id + 1;
+    Event event(std::stoi(token));
+    reserveIds(event.id);
     
     // Parse title
-    std::getline(iss, event.title, '|');
+    std::string title;
+    readText(iss, title);
     
     // Parse description
-    std::getline(iss, event.description, '|');
+    std::string description;
+    readText(iss, description);
+    event.text = TextStore::instance().make(std::move(title), std::move(description));
     
     // Parse event time
     std::getline(iss, token, '|');
@@ -86,16 +211,93 @@ Event Event::deserialize(const std::string& data) {
     // Parse completion status
     std::getline(iss, token, '|');
     event.isCompleted = (token == "1");
+    event.seriesStart = event.eventTime;
+    
+    // Optional recurrence fields
+    if (std::getline(iss, token, '|') && RecurrenceRule::parse(token, event.recurrence)) {
+        std::getline(iss, token, '|');
+        event.seriesStart = std::stoll(token);
+        std::getline(iss, token, '|');
+        event.occurrenceIndex = std::stol(token);
+        
+        if (std::getline(iss, token, '|')) {
+            event.setDuration(std::stoll(token));
+        }
+    }
     
     return event;
 }
 
-void Event::display() const {
-    std::cout << "ID: " << id << std::endl;
-    std::cout << "Title: " << title << std::endl;
-    std::cout << "Description: " << description << std::endl;
-    std::cout << "Date & Time: " << getFormattedTime() << std::endl;
-    std::cout << "Priority: " << getPriorityString() << std::endl;
-    std::cout << "Status: " << (isCompleted ? "Completed" : (isDue() ? "Due" : "Upcoming")) << std::endl;
-    std::cout << "----------------------------------------" << std::endl;
+void Event::display(std::time_t now) const {
+    std::string out;
+    render(out, now);
+    std::cout << out << std::flush;
+}
+
+namespace {
+
+const char* statusString(bool completed, bool due) {
+    return completed ? "Completed" : (due ? "Due" : "Upcoming");
+}
+
+void appendTime(std::string& out, std::time_t time) {
+    char buffer[32];
+    std::tm* timeinfo = std::localtime(&time);
+    size_t length = timeinfo ? std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", timeinfo) : 0;
+    out.append(buffer, length);
+}
+
+void appendPadded(std::string& out, const std::string& text, size_t width) {
+    if (text.size() >= width) {
+        out.append(text, 0, width);
+    } else {
+        out += text;
+        out.append(width - text.size(), ' ');
+    }
+}
+
+} // namespace
+
+void Event::render(std::string& out, std::time_t now) const {
+    std::string title, description;
+    out += "ID: ";
+    out += std::to_string(id);
+    out += "\nTitle: ";
+    out += TextStore::instance().title(*text, title);
+    out += "\nDescription: ";
+    out += TextStore::instance().description(*text, description);
+    out += "\nDate & Time: ";
+    appendTime(out, eventTime);
+    if (duration > 0) {
+        out += "\nEnds: ";
+        appendTime(out, eventTime + duration);
+    }
+    out += "\nPriority: ";
+    out += getPriorityString();
+    if (recurrence.isRecurring()) {
+        out += "\nRepeats: ";
+        out += recurrence.describe();
+    }
+    out += "\nStatus: ";
+    out += statusString(isCompleted, isDue(now));
+    out += "\n----------------------------------------\n";
+}
+
+void Event::renderTableHeader(std::string& out) {
+    out += "ID     | Date & Time         | Priority | Status    | Title\n";
+    out += "-------+---------------------+----------+-----------+----------------------------------------\n";
+}
+
+void Event::renderRow(std::string& out, std::time_t now) const {
+    appendPadded(out, std::to_string(id), 6);
+    out += " | ";
+    appendTime(out, eventTime);
+    out += " | ";
+    appendPadded(out, getPriorityString(), 8);
+    out += " | ";
+    appendPadded(out, statusString(isCompleted, isDue(now)), 9);
+    out += " | ";
+    std::string title;
+    out.append(TextStore::instance().title(*text, title), 0, 40);
+    out += '\n';
 }
@@ -1,167 +1,512 @@
 #include "../include/EventManager.h"
+#include "../include/EventRenderer.h"
 #include <iostream>
 #include <algorithm>
+#include <limits>
 
-EventManager::EventManager() : head(nullptr), eventCount(0) {}
+namespace {
+
+std::time_t atMinute(std::tm day, int minute) {
+    day.tm_hour = 0;
+    day.tm_min = minute;
+    day.tm_sec = 0;
+    day.tm_isdst = -1;
+    return std::mktime(&day);
+}
+
+// Emits the parts of a free gap that are long enough, split by working hours
+void addFreeGap(std::time_t start, std::time_t end, std::time_t minLength, size_t count,
+                const WorkingHours& hours, std::vector<TimeSlot>& slots) {
+    if (end - start < minLength) return;
+    if (!hours.enabled) {
+        slots.push_back(TimeSlot{start, end});
+        return;
+    }
+    
+    std::tm* local = std::localtime(&start);
+    if (local == nullptr) return;
+    std::tm day = *local;
+    while (slots.size() < count) {
+        std::time_t dayStart = atMinute(day, 0);
+        if (dayStart >= end) break;
+        
+        std::tm normalized = day;
+        normalized.tm_isdst = -1;
+        std::mktime(&normalized);
+        bool weekend = normalized.tm_wday == 0 || normalized.tm_wday == 6;
+        if (!(hours.weekdaysOnly && weekend)) {
+            std::time_t windowStart = std::max(start, atMinute(day, hours.startMinute));
+            std::time_t windowEnd = std::min(end, atMinute(day, hours.endMinute));
+            if (windowEnd - windowStart >= minLength) {
+                slots.push_back(TimeSlot{windowStart, windowEnd});
+            }
+        }
+        day.tm_mday++; // mktime normalizes month and year overflow
+    }
+}
+
+} // namespace
+
+void EventPatch::applyTo(Event& event) const {
+    if (hasTitle && hasDescription) {
+        event.setText(title, description);
+    } else if (hasTitle) {
+        event.setTitle(title);
+    } else if (hasDescription) {
+        event.setDescription(description);
+    }
+    if (hasTime) event.setEventTime(eventTime);
+    if (hasDuration) event.setDuration(duration);
+    if (hasPriority) event.setPriority(priority);
+}
+
+EventManager::EventManager(const Clock& clock)
+    : head(nullptr), eventCount(0), clock(&clock), pendingCount(0), priorityCounts{0, 0, 0},
+      dueWatermark(clock.now()), dueCount(0) {}
 
 EventManager::~EventManager() {
     clearList();
 }
 
 void EventManager::clearList() {
+    scheduler.clear();
+    slots.clear();
     while (head != nullptr) {
         EventNode* temp = head;
         head = head->next;
         delete temp;
     }
+    handles.clear();
+    idIndex.clear();
+    orderIndex.clear();
+    timeIndex.clear();
+    recurring.clear();
+    store = PersistentEventMap();
     eventCount = 0;
+    pendingCount = 0;
+    std::fill(priorityCounts, priorityCounts + 3, 0);
+    dueCount = 0;
 }
 
-void EventManager::insertSorted(const Event& event) {
-    EventNode* newNode = new EventNode(event);
+void EventManager::splice(EventNode* previous, EventNode* node) {
+    node->prev = previous;
+    node->next = previous ? previous->next : head;
+    if (node->next != nullptr) {
+        node->next->prev = node;
+    }
+    if (previous != nullptr) {
+        previous->next = node;
+    } else {
+        head = node;
+    }
+}
+
+void EventManager::linkAfter(EventNode* previous, EventNode* node) {
+    splice(previous, node);
+    attach(node);
+    if (!node->event.getIsCompleted()) {
+        slots.insert(node);
+    }
+}
+
+void EventManager::attach(EventNode* node) {
+    idIndex[node->event.getId()] = node;
+    if (!node->event.getIsCompleted()) {
+        scheduler.push(node);
+        if (node->event.isRecurring()) recurring.insert(node);
+    }
+    store.assign(std::make_shared<const Event>(node->event));
+    account(node->event, 1);
+}
+
+void EventManager::unlink(EventNode* node) {
+    if (node->prev != nullptr) {
+        node->prev->next = node->next;
+    } else {
+        head = node->next;
+    }
+    if (node->next != nullptr) {
+        node->next->prev = node->prev;
+    }
     
-    // If list is empty or new event should be first
-    if (head == nullptr || event < head->event) {
-        newNode->next = head;
-        head = newNode;
-        eventCount++;
-        return;
+    // Drop the node's ordering entry (equal keys are rare, so the range is short)
+    auto range = orderIndex.equal_range(OrderKey(node->event.getPriority(), node->event.getEventTime()));
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == node) {
+            orderIndex.erase(it);
+            break;
+        }
     }
     
-    // Find the correct position
-    EventNode* current = head;
-    while (current->next != nullptr && current->next->event < event) {
-        current = current->next;
+    auto times = timeIndex.equal_range(node->event.getEventTime());
+    for (auto it = times.first; it != times.second; ++it) {
+        if (it->second == node) {
+            timeIndex.erase(it);
+            break;
+        }
     }
     
-    newNode->next = current->next;
-    current->next = newNode;
-    eventCount++;
+    idIndex.erase(node->event.getId());
+    recurring.erase(node);
+    scheduler.erase(node);
+    slots.erase(node);
+    store.remove(node->event.getId());
+    account(node->event, -1);
 }
 
-EventNode* EventManager::findEventById(int id) {
-    EventNode* current = head;
-    while (current != nullptr) {
-        if (current->event.getId() == id) {
-            return current;
+void EventManager::account(const Event& event, int delta) {
+    eventCount += delta;
+    int priority = event.getPriority();
+    if (priority >= 1 && priority <= 3) {
+        priorityCounts[priority - 1] += delta;
+    }
+    if (!event.getIsCompleted()) {
+        pendingCount += delta;
+        if (event.getEventTime() <= dueWatermark) {
+            dueCount += delta;
+        }
+    }
+}
+
+void EventManager::advanceDueWatermark(std::time_t now) const {
+    if (now > dueWatermark) {
+        auto end = timeIndex.upper_bound(now);
+        for (auto it = timeIndex.upper_bound(dueWatermark); it != end; ++it) {
+            if (!it->second->event.getIsCompleted()) dueCount++;
+        }
+    } else if (now < dueWatermark) {
+        // The clock went backwards (e.g. a virtual clock was reset)
+        auto end = timeIndex.upper_bound(dueWatermark);
+        for (auto it = timeIndex.upper_bound(now); it != end; ++it) {
+            if (!it->second->event.getIsCompleted()) dueCount--;
         }
-        current = current->next;
     }
-    return nullptr;
+    dueWatermark = now;
+}
+
+int EventManager::getDueCount() const {
+    advanceDueWatermark(clock->now());
+    return dueCount;
+}
+
+EventStats EventManager::getStats() const {
+    EventStats stats;
+    stats.total = eventCount;
+    stats.pending = pendingCount;
+    stats.completed = eventCount - pendingCount;
+    stats.due = getDueCount();
+    stats.upcoming = pendingCount - stats.due;
+    std::copy(priorityCounts, priorityCounts + 3, stats.byPriority);
+    return stats;
+}
+
+EventNode* EventManager::newNode(const Event& event) {
+    EventNode* node = new EventNode(event);
+    node->handle = handles.insert(node);
+    return node;
+}
+
+void EventManager::deleteNode(EventNode* node) {
+    handles.erase(node->handle);
+    delete node;
+}
+
+EventNode* EventManager::nodeFor(EventHandle handle) const {
+    EventNode* const* node = handles.get(handle);
+    return node ? *node : nullptr;
+}
+
+void EventManager::insertSorted(const Event& event) {
+    insertNode(newNode(event));
+}
+
+void EventManager::insertNode(EventNode* node) {
+    // Insert after any events with an equal key, so equal events keep insertion order
+    OrderKey key(node->event.getPriority(), node->event.getEventTime());
+    auto next = orderIndex.upper_bound(key);
+    EventNode* previous = (next == orderIndex.begin()) ? nullptr : std::prev(next)->second;
+    
+    orderIndex.insert(next, std::make_pair(key, node));
+    timeIndex.insert(std::make_pair(node->event.getEventTime(), node));
+    linkAfter(previous, node);
+}
+
+EventNode* EventManager::findEventById(int id) {
+    auto it = idIndex.find(id);
+    return it != idIndex.end() ? it->second : nullptr;
 }
 
 void EventManager::addEvent(const Event& event) {
     insertSorted(event);
+    changes.publish(ChangeType::Added, event.getId(), event);
 }
 
-bool EventManager::removeEvent(int id) {
-    if (head == nullptr) return false;
-    
-    // If first node is to be deleted
-    if (head->event.getId() == id) {
-        EventNode* temp = head;
-        head = head->next;
-        delete temp;
-        eventCount--;
-        return true;
+void EventManager::addEvents(const std::vector<Event>& events) {
+    if (events.size() > 1) {
+        bulkLoad(events);
+        for (const Event& event : events) {
+            changes.publish(ChangeType::Added, event.getId(), event);
+        }
+        return;
     }
     
-    // Find the node to delete
-    EventNode* current = head;
-    while (current->next != nullptr && current->next->event.getId() != id) {
-        current = current->next;
+    idIndex.reserve(idIndex.size() + events.size());
+    for (const Event& event : events) {
+        addEvent(event);
+    }
+}
+
+void EventManager::bulkLoad(const std::vector<Event>& events) {
+    // One sort instead of a tree search per event. The sorted events are then
+    // merged into the ordered indexes front to back: each goes at or after
+    // the previous one, so an index is searched only when an existing entry
+    // lies in between (never, for an empty manager). The interval tree is
+    // built bottom-up and merged in.
+    std::vector<EventNode*> byTime;
+    byTime.reserve(events.size());
+    handles.reserve(handles.size() + events.size());
+    for (const Event& event : events) {
+        byTime.push_back(newNode(event));
     }
+    std::vector<EventNode*> byOrder(byTime);
     
-    if (current->next == nullptr) return false;
+    // Stable sorts keep equal keys in input order, as addEvent would
+    std::stable_sort(byOrder.begin(), byOrder.end(), [](const EventNode* a, const EventNode* b) {
+        return OrderKey(a->event.getPriority(), a->event.getEventTime()) <
+               OrderKey(b->event.getPriority(), b->event.getEventTime());
+    });
+    std::stable_sort(byTime.begin(), byTime.end(), [](const EventNode* a, const EventNode* b) {
+        return a->event.getEventTime() < b->event.getEventTime();
+    });
     
-    EventNode* temp = current->next;
-    current->next = current->next->next;
-    delete temp;
-    eventCount--;
+    idIndex.reserve(idIndex.size() + byOrder.size());
+    std::vector<EventNode*> pending;
+    auto next = orderIndex.begin(); // First entry ordered after the node being merged
+    for (EventNode* node : byOrder) {
+        OrderKey key(node->event.getPriority(), node->event.getEventTime());
+        if (next != orderIndex.end() && !(key < next->first)) {
+            next = orderIndex.upper_bound(key); // After equal keys, as insertNode does
+        }
+        EventNode* previous = (next == orderIndex.begin()) ? nullptr : std::prev(next)->second;
+        orderIndex.emplace_hint(next, key, node);
+        splice(previous, node);
+        attach(node);
+        if (!node->event.getIsCompleted()) pending.push_back(node);
+    }
+    auto later = timeIndex.begin();
+    for (EventNode* node : byTime) {
+        std::time_t time = node->event.getEventTime();
+        if (later != timeIndex.end() && !(time < later->first)) {
+            later = timeIndex.upper_bound(time);
+        }
+        timeIndex.emplace_hint(later, time, node);
+    }
+    slots.insertAll(pending);
+}
+
+bool EventManager::removeEvent(int id) {
+    return removeEvent(findEvent(id));
+}
+
+bool EventManager::removeEvent(EventHandle handle) {
+    EventNode* node = nodeFor(handle);
+    if (node == nullptr) return false;
+    
+    unlink(node);
+    changes.publish(ChangeType::Removed, node->event.getId(), node->event);
+    deleteNode(node);
     return true;
 }
 
 bool EventManager::updateEvent(int id, const Event& updatedEvent) {
-    EventNode* node = findEventById(id);
+    return updateEvent(findEvent(id), updatedEvent);
+}
+
+bool EventManager::updateEvent(EventHandle handle, const Event& updatedEvent) {
+    EventNode* node = nodeFor(handle);
     if (node == nullptr) return false;
     
-    // Remove old event and add updated one to maintain sorting
-    removeEvent(id);
-    addEvent(updatedEvent);
+    int id = node->event.getId();
+    replaceEvent(node, updatedEvent);
+    changes.publish(ChangeType::Updated, id, updatedEvent);
     return true;
 }
 
-Event* EventManager::findEvent(int id) {
-    EventNode* node = findEventById(id);
-    return node ? &(node->event) : nullptr;
+bool EventManager::patchEvent(int id, const EventPatch& patch) {
+    return patchEvent(findEvent(id), patch);
 }
 
-void EventManager::displayAllEvents() const {
-    if (head == nullptr) {
-        std::cout << "No events found." << std::endl;
+bool EventManager::patchEvent(EventHandle handle, const EventPatch& patch) {
+    EventNode* node = nodeFor(handle);
+    if (node == nullptr) return false;
+    
+    Event updated = node->event; // Shares the text unless the patch replaces it
+    patch.applyTo(updated);
+    replaceEvent(node, updated);
+    changes.publish(ChangeType::Updated, updated.getId(), node->event);
+    return true;
+}
+
+void EventManager::replaceEvent(EventNode* node, const Event& updated) {
+    const Event& current = node->event;
+    if (current.getId() != updated.getId() || current.getPriority() != updated.getPriority() ||
+        current.getEventTime() != updated.getEventTime() || current.getIsCompleted() != updated.getIsCompleted()) {
+        // Relink the same node to maintain sorting, so its handle stays valid
+        unlink(node);
+        node->event = updated;
+        insertNode(node);
         return;
     }
     
-    std::cout << "\n=== ALL EVENTS ===" << std::endl;
-    EventNode* current = head;
-    while (current != nullptr) {
-        current->event.display();
-        current = current->next;
+    // Same place in every index and the same counts; only a pending event's
+    // time slot can change shape
+    bool reslot = !current.getIsCompleted() && current.getEndTime() != updated.getEndTime();
+    if (reslot) slots.erase(node);
+    node->event = updated;
+    if (reslot) slots.insert(node);
+    if (!updated.getIsCompleted() && updated.isRecurring()) {
+        recurring.insert(node);
+    } else {
+        recurring.erase(node);
     }
+    store.assign(std::make_shared<const Event>(node->event));
 }
 
-void EventManager::displayUpcomingEvents() const {
-    std::cout << "\n=== UPCOMING EVENTS ===" << std::endl;
-    bool found = false;
-    EventNode* current = head;
+void EventManager::clear() {
+    clearList();
+    changes.publish(ChangeType::Cleared, 0, Event::none());
+}
+
+void EventManager::restore(const PersistentEventMap& target) {
+    // Gather first: applying changes replaces store, which the diff is walking
+    std::vector<std::pair<const Event*, const Event*>> differences;
+    PersistentEventMap current = store;
+    PersistentEventMap::diff(current, target, [&differences](const Event* before, const Event* after) {
+        differences.push_back(std::make_pair(before, after));
+    });
     
-    while (current != nullptr) {
-        if (current->event.isUpcoming()) {
-            current->event.display();
-            found = true;
+    for (const auto& change : differences) {
+        // An event that changed keeps its node, and with it its handle
+        EventNode* node = change.first != nullptr ? findEventById(change.first->getId()) : nullptr;
+        if (node != nullptr) {
+            if (change.second != nullptr) {
+                replaceEvent(node, *change.second);
+            } else {
+                unlink(node);
+                deleteNode(node);
+            }
+        } else if (change.second != nullptr) {
+            insertSorted(*change.second);
         }
-        current = current->next;
+        
+        ChangeType type = change.first == nullptr ? ChangeType::Added
+                        : change.second == nullptr ? ChangeType::Removed : ChangeType::Updated;
+        const Event& event = change.second != nullptr ? *change.second : *change.first;
+        changes.publish(type, event.getId(), event);
     }
     
-    if (!found) {
-        std::cout << "No upcoming events." << std::endl;
-    }
+    // Adopt the target version itself so later snapshots share its nodes
+    store = target;
 }
 
-void EventManager::displayDueEvents() const {
-    std::cout << "\n=== DUE EVENTS ===" << std::endl;
-    bool found = false;
+std::vector<Event> EventManager::extractEvents(const EventFilter& filter) {
+    std::vector<Event> extracted;
     EventNode* current = head;
-    
     while (current != nullptr) {
-        if (current->event.isDue()) {
-            current->event.display();
-            found = true;
+        EventNode* next = current->next;
+        if (filter(current->event)) {
+            extracted.push_back(current->event);
+            unlink(current);
+            changes.publish(ChangeType::Removed, current->event.getId(), current->event);
+            deleteNode(current);
+        }
+        current = next;
+    }
+    return extracted;
+}
+
+EventHandle EventManager::findEvent(int id) const {
+    auto it = idIndex.find(id);
+    return it != idIndex.end() ? it->second->handle : NO_EVENT;
+}
+
+const Event* EventManager::getEvent(EventHandle handle) const {
+    EventNode* node = nodeFor(handle);
+    return node ? &node->event : nullptr;
+}
+
+std::vector<const Event*> EventManager::nextPage(EventCursor& cursor, size_t pageSize,
+                                                 const EventFilter& filter) const {
+    std::vector<const Event*> page;
+    if (!cursor.started) {
+        cursor.next = head;
+        cursor.started = true;
+    }
+    
+    const EventNode* current = cursor.next;
+    while (current != nullptr && page.size() < pageSize) {
+        if (!filter || filter(current->event)) {
+            page.push_back(&current->event);
         }
         current = current->next;
     }
     
-    if (!found) {
-        std::cout << "No due events." << std::endl;
+    // Skip trailing non-matches so atEnd() is accurate for the caller
+    while (filter && current != nullptr && !filter(current->event)) {
+        current = current->next;
     }
+    cursor.next = current;
+    return page;
 }
 
-void EventManager::displayEventsByPriority(int priority) const {
-    std::cout << "\n=== EVENTS BY PRIORITY ===" << std::endl;
-    bool found = false;
-    EventNode* current = head;
+void EventManager::displayFiltered(const std::string& heading, std::time_t now,
+                                   const EventFilter& filter, const std::string& emptyMessage) const {
+    const size_t eventsPerWrite = 256;
+    EventRenderer renderer(RenderFormat::Detailed, now);
+    renderer.line(heading);
     
-    while (current != nullptr) {
-        if (current->event.getPriority() == priority) {
-            current->event.display();
+    bool found = false;
+    EventCursor cursor;
+    while (!cursor.atEnd()) {
+        for (const Event* event : nextPage(cursor, eventsPerWrite, filter)) {
+            renderer.add(*event);
             found = true;
         }
-        current = current->next;
+        renderer.flush();
     }
     
     if (!found) {
-        std::cout << "No events found with specified priority." << std::endl;
+        std::cout << emptyMessage << std::endl;
+    }
+}
+
+void EventManager::displayAllEvents() const {
+    if (head == nullptr) {
+        std::cout << "No events found." << std::endl;
+        return;
     }
+    
+    displayFiltered("\n=== ALL EVENTS ===", clock->now(), EventFilter(), "No events found.");
+}
+
+void EventManager::displayUpcomingEvents() const {
+    std::time_t now = clock->now();
+    displayFiltered("\n=== UPCOMING EVENTS ===", now,
+                    [now](const Event& event) { return event.isUpcoming(now); },
+                    "No upcoming events.");
+}
+
+void EventManager::displayDueEvents() const {
+    std::time_t now = clock->now();
+    displayFiltered("\n=== DUE EVENTS ===", now,
+                    [now](const Event& event) { return event.isDue(now); },
+                    "No due events.");
+}
+
+void EventManager::displayEventsByPriority(int priority) const {
+    displayFiltered("\n=== EVENTS BY PRIORITY ===", clock->now(),
+                    [priority](const Event& event) { return event.getPriority() == priority; },
+                    "No events found with specified priority.");
 }
 
 std::vector<Event> EventManager::searchByTitle(const std::string& title) const {
@@ -191,40 +536,267 @@ std::vector<Event> EventManager::getAllEvents() const {
 }
 
 void EventManager::markEventCompleted(int id) {
-    EventNode* node = findEventById(id);
-    if (node != nullptr) {
+    markEventCompleted(findEvent(id));
+}
+
+bool EventManager::markEventCompleted(EventHandle handle) {
+    EventNode* node = nodeFor(handle);
+    if (node == nullptr) return false;
+    int id = node->event.getId();
+    
+    if (!node->event.isRecurring()) {
+        if (!node->event.getIsCompleted()) {
+            scheduler.erase(node);
+            slots.erase(node);
+            account(node->event, -1);
+            node->event.setCompleted(true);
+            account(node->event, 1);
+            store.assign(std::make_shared<const Event>(node->event));
+            changes.publish(ChangeType::Completed, id, node->event);
+        }
+        return true;
+    }
+    
+    // Completing a recurring event moves it to its next occurrence after now;
+    // occurrences missed in between are completed along with it
+    unlink(node);
+    if (!node->event.advanceOccurrence(clock->now())) {
         node->event.setCompleted(true);
     }
+    insertNode(node);
+    changes.publish(ChangeType::Completed, id, node->event);
+    return true;
 }
 
-std::vector<Event> EventManager::getDueReminders() const {
-    std::vector<Event> dueEvents;
-    EventNode* current = head;
+std::vector<Event> EventManager::nextEvents(size_t k, const EventFilter& filter) const {
+    std::time_t now = clock->now();
     
-    while (current != nullptr) {
-        if (current->event.isDue()) {
-            dueEvents.push_back(current->event);
+    // A series whose stored occurrence has passed sits behind now in the time
+    // index; seek it to its next occurrence and merge it into the walk
+    std::vector<Event> behind;
+    for (const EventNode* node : recurring) {
+        if (node->event.getEventTime() >= now) continue; // The walk reaches it
+        OccurrenceIterator occurrence = node->event.occurrences();
+        occurrence.seek(now);
+        if (!occurrence.isValid()) continue;
+        Event event = node->event.atOccurrence(occurrence);
+        if (!filter || filter(event)) behind.push_back(std::move(event));
+    }
+    std::sort(behind.begin(), behind.end(), [](const Event& a, const Event& b) {
+        return a.getEventTime() != b.getEventTime() ? a.getEventTime() < b.getEventTime() : a.getId() < b.getId();
+    });
+    
+    std::vector<Event> events;
+    auto it = timeIndex.lower_bound(now);
+    size_t next = 0;
+    while (events.size() < k) {
+        while (it != timeIndex.end() &&
+               (it->second->event.getIsCompleted() || (filter && !filter(it->second->event)))) {
+            ++it;
+        }
+        if (next < behind.size() && (it == timeIndex.end() || behind[next].getEventTime() < it->first)) {
+            events.push_back(behind[next++]);
+        } else if (it != timeIndex.end()) {
+            events.push_back(it->second->event);
+            ++it;
+        } else {
+            break;
         }
-        current = current->next;
     }
+    return events;
+}
+
+std::vector<Event> EventManager::laterOccurrences(std::time_t from, std::time_t to) const {
+    std::vector<Event> events;
+    for (const EventNode* node : recurring) {
+        const Event& event = node->event;
+        std::time_t length = IntervalTree::slotEnd(event) - event.getEventTime();
+        OccurrenceIterator occurrence = event.occurrences();
+        long stored = occurrence.getIndex();
+        occurrence.seek(from - length + 1); // Still running at 'from'
+        for (; occurrence.isValid() && occurrence.time() < to; occurrence.next()) {
+            if (occurrence.getIndex() != stored) events.push_back(event.atOccurrence(occurrence));
+        }
+    }
+    std::sort(events.begin(), events.end(), [](const Event& a, const Event& b) {
+        return a.getEventTime() != b.getEventTime() ? a.getEventTime() < b.getEventTime() : a.getId() < b.getId();
+    });
+    return events;
+}
+
+std::vector<Event> EventManager::findOverlapping(std::time_t from, std::time_t to, int excludeId) const {
+    std::vector<Event> events;
+    for (const EventNode* node : slots.overlapping(from, to)) {
+        if (node->event.getId() != excludeId) {
+            events.push_back(node->event);
+        }
+    }
+    
+    // The slots hold one occurrence per series; merge in the rest by start time
+    size_t indexed = events.size();
+    for (Event& occurrence : laterOccurrences(from, to)) {
+        if (occurrence.getId() != excludeId) {
+            events.push_back(std::move(occurrence));
+        }
+    }
+    std::inplace_merge(events.begin(), events.begin() + indexed, events.end(),
+                       [](const Event& a, const Event& b) { return a.getEventTime() < b.getEventTime(); });
+    return events;
+}
+
+std::vector<Event> EventManager::findConflicts(const Event& event, int excludeId) const {
+    return findOverlapping(event.getEventTime(), IntervalTree::slotEnd(event), excludeId);
+}
+
+std::vector<TimeSlot> EventManager::findFreeSlots(std::time_t from, std::time_t to, std::time_t minLength,
+                                                  size_t count, const WorkingHours& hours) const {
+    std::vector<TimeSlot> free;
+    if (minLength < 1) minLength = 1;
+    
+    // Events that started earlier may still be running at 'from'
+    std::time_t cursor = from;
+    for (const EventNode* node : slots.overlapping(from, from + 1)) {
+        cursor = std::max(cursor, IntervalTree::slotEnd(node->event));
+    }
+    
+    // Later occurrences of recurring series are not in the time index
+    std::vector<Event> repeats = laterOccurrences(from, to);
+    size_t next = 0;
     
+    auto it = timeIndex.lower_bound(from);
+    while (cursor < to && free.size() < count) {
+        if (it != timeIndex.end() && it->first < to && it->second->event.getIsCompleted()) {
+            ++it;
+            continue;
+        }
+        
+        bool indexed = it != timeIndex.end() && it->first < to;
+        bool repeated = next < repeats.size();
+        if (!indexed && !repeated) {
+            addFreeGap(cursor, to, minLength, count, hours, free);
+            break;
+        }
+        
+        const Event* event;
+        if (repeated && (!indexed || repeats[next].getEventTime() < it->first)) {
+            event = &repeats[next++];
+        } else {
+            event = &(it++)->second->event;
+        }
+        if (event->getEventTime() > cursor) {
+            addFreeGap(cursor, event->getEventTime(), minLength, count, hours, free);
+        }
+        cursor = std::max(cursor, IntervalTree::slotEnd(*event));
+    }
+    
+    if (free.size() > count) free.resize(count);
+    return free;
+}
+
+std::vector<Event> EventManager::nextTasks(size_t k) const {
+    std::vector<Event> tasks;
+    for (const EventNode* node : scheduler.top(k)) {
+        tasks.push_back(node->event);
+    }
+    return tasks;
+}
+
+std::vector<const EventNode*> EventManager::inListOrder(std::vector<const EventNode*> nodes) const {
+    auto keyOf = [](const EventNode* node) {
+        return OrderKey(node->event.getPriority(), node->event.getEventTime());
+    };
+    std::sort(nodes.begin(), nodes.end(), [&keyOf](const EventNode* a, const EventNode* b) {
+        return keyOf(a) < keyOf(b);
+    });
+    
+    std::vector<const EventNode*> ordered;
+    ordered.reserve(nodes.size());
+    for (size_t i = 0; i < nodes.size();) {
+        OrderKey key = keyOf(nodes[i]);
+        size_t end = i + 1;
+        while (end < nodes.size() && keyOf(nodes[end]) == key) ++end;
+        if (end - i == 1) {
+            ordered.push_back(nodes[i]);
+        } else {
+            // Equal keys keep insertion order, which only the order index knows
+            auto range = orderIndex.equal_range(key);
+            for (auto it = range.first; it != range.second; ++it) {
+                if (std::find(nodes.begin() + i, nodes.begin() + end, it->second) != nodes.begin() + end) {
+                    ordered.push_back(it->second);
+                }
+            }
+        }
+        i = end;
+    }
+    return ordered;
+}
+
+std::vector<Event> EventManager::getDueReminders() const {
+    // The slots hold exactly the pending events; those starting by now are due
+    std::time_t now = clock->now();
+    std::vector<const EventNode*> due = slots.overlapping(std::numeric_limits<std::time_t>::min(), now + 1);
+    
+    std::vector<Event> dueEvents;
+    dueEvents.reserve(due.size());
+    for (const EventNode* node : inListOrder(std::move(due))) {
+        dueEvents.push_back(node->event);
+    }
     return dueEvents;
 }
 
 std::vector<Event> EventManager::getUpcomingReminders(int hours) const {
+    std::time_t now = clock->now();
+    std::time_t futureTime = now + static_cast<std::time_t>(hours) * 3600; // Convert hours to seconds
+    
+    std::vector<const EventNode*> upcoming;
+    for (auto it = timeIndex.upper_bound(now); it != timeIndex.end() && it->first <= futureTime; ++it) {
+        const Event& event = it->second->event;
+        if (!event.getIsCompleted() && !event.isRecurring()) upcoming.push_back(it->second);
+    }
+    for (const EventNode* node : recurring) {
+        OccurrenceIterator occurrence = node->event.occurrences();
+        occurrence.seek(now + 1);
+        if (occurrence.isValid() && occurrence.time() <= futureTime) upcoming.push_back(node);
+    }
+    
     std::vector<Event> upcomingEvents;
-    std::time_t now = std::time(nullptr);
-    std::time_t futureTime = now + (hours * 3600); // Convert hours to seconds
+    for (const EventNode* node : inListOrder(std::move(upcoming))) {
+        const Event& event = node->event;
+        if (event.isRecurring()) {
+            // Expand only the occurrences that fall inside the window
+            OccurrenceIterator occurrence = event.occurrences();
+            occurrence.seek(now + 1);
+            for (; occurrence.isValid() && occurrence.time() <= futureTime; occurrence.next()) {
+                upcomingEvents.push_back(event.atOccurrence(occurrence));
+            }
+        } else {
+            upcomingEvents.push_back(event);
+        }
+    }
+    return upcomingEvents;
+}
+
+std::vector<Event> EventManager::getEventsInRange(std::time_t from, std::time_t to) const {
+    std::vector<Event> events;
     
     EventNode* current = head;
     while (current != nullptr) {
-        if (current->event.getEventTime() > now && 
-            current->event.getEventTime() <= futureTime &&
-            !current->event.getIsCompleted()) {
-            upcomingEvents.push_back(current->event);
+        const Event& event = current->event;
+        if (event.isRecurring()) {
+            // Whole series, including occurrences already completed
+            OccurrenceIterator occurrence(event.getRecurrence(), event.getSeriesStart());
+            occurrence.seek(from);
+            for (; occurrence.isValid() && occurrence.time() < to; occurrence.next()) {
+                events.push_back(event.atOccurrence(occurrence));
+            }
+        } else if (event.getEventTime() >= from && event.getEventTime() < to) {
+            events.push_back(event);
         }
         current = current->next;
     }
     
-    return upcomingEvents;
+    std::stable_sort(events.begin(), events.end(), [](const Event& a, const Event& b) {
+        return a.getEventTime() < b.getEventTime();
+    });
+    return events;
 }
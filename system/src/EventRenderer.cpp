@@ -0,0 +1,55 @@
+#include "../include/EventRenderer.h"
+#include <iostream>
+#include <cstdio>
+#ifndef _WIN32
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+EventRenderer::EventRenderer(RenderFormat format, std::time_t now)
+    : format(format), now(now), tableHeaderPending(true) {
+    buffer.reserve(DEFAULT_CAPACITY);
+}
+
+void EventRenderer::line(const std::string& text) {
+    buffer += text;
+    buffer += '\n';
+}
+
+void EventRenderer::add(const Event& event) {
+    if (format == RenderFormat::Compact) {
+        if (tableHeaderPending) {
+            Event::renderTableHeader(buffer);
+            tableHeaderPending = false;
+        }
+        event.renderRow(buffer, now);
+    } else {
+        event.render(buffer, now);
+    }
+}
+
+void EventRenderer::flush() {
+    if (buffer.empty()) return;
+
+    // Keep ordering with anything already written through std::cout
+    std::cout.flush();
+
+#ifdef _WIN32
+    std::fwrite(buffer.data(), 1, buffer.size(), stdout);
+    std::fflush(stdout);
+#else
+    const char* data = buffer.data();
+    size_t remaining = buffer.size();
+    while (remaining > 0) {
+        ssize_t written = ::write(STDOUT_FILENO, data, remaining);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        data += written;
+        remaining -= static_cast<size_t>(written);
+    }
+#endif
+
+    buffer.clear();
+}
@@ -0,0 +1,400 @@
+#include "../include/EventServer.h"
+#include "../include/ArchiveStore.h"
+#include <iostream>
+#include <csignal>
+#include <cstring>
+#include <cstdint>
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+#include <ctime>
+#endif
+
+namespace {
+
+volatile std::sig_atomic_t stopRequested = 0;
+
+void requestStop(int) {
+    stopRequested = 1;
+}
+
+const size_t READ_CHUNK = 64 * 1024;
+// A connection stops reading once this much unhandled input is buffered; it
+// holds one largest frame, so a complete request always fits
+const size_t MAX_INPUT_BUFFER = sizeof(uint32_t) + Protocol::MAX_BODY;
+// Requests wait, and the socket is not read, while more than this much response
+// data is queued, so output never grows past it by more than one response
+const size_t OUTPUT_HIGH_WATER = 1024 * 1024;
+const int MAX_EPOLL_EVENTS = 64;
+
+} // namespace
+
+EventServer::EventServer(EventManager& manager, const ServerConfig& config)
+    : config(config), manager(manager), fileHandler(config.dataFile),
+      listenFd(-1), epollFd(-1), dirty(false) {
+    feedHandle = manager.getChangeFeed().subscribe([this](const ChangeRecord&) { dirty = true; });
+    fileHandler.setSyncWrites(config.syncWrites);
+}
+
+EventServer::~EventServer() {
+    manager.getChangeFeed().unsubscribe(feedHandle);
+#ifdef __linux__
+    for (auto& entry : connections) {
+        ::close(entry.first);
+    }
+    if (listenFd >= 0) {
+        ::close(listenFd);
+        ::unlink(config.socketPath.c_str());
+    }
+    if (epollFd >= 0) ::close(epollFd);
+#endif
+}
+
+bool EventServer::loadData() {
+    ArchiveStore(ArchiveStore::forDataFile(config.dataFile)).reserveIds();
+    bool loaded = fileHandler.loadEvents(manager);
+    dirty = false; // Loading is not a change worth saving
+    return loaded;
+}
+
+void EventServer::persist() {
+    if (dirty) {
+        snapshotWriter.submit(fileHandler, manager.snapshot());
+        dirty = false;
+    }
+}
+
+void EventServer::writeEvents(const std::vector<Event>& events, uint32_t requestId, std::string& out) {
+    Protocol::Writer writer(out, Protocol::STATUS_OK, requestId);
+    writer.u32(static_cast<uint32_t>(events.size()));
+    for (const Event& event : events) {
+        writer.event(event);
+    }
+    writer.finish();
+}
+
+void EventServer::handleRequest(uint8_t opcode, uint32_t requestId, Protocol::Reader& reader, std::string& out) {
+    switch (opcode) {
+        case Protocol::OP_PING:
+            break;
+        case Protocol::OP_ADD: {
+            std::string title = reader.str();
+            std::string description = reader.str();
+            int64_t time = reader.i64();
+            uint8_t priority = reader.u8();
+            if (!reader.ok() || priority < 1 || priority > 3) break;
+
+            Event event(title, description, static_cast<std::time_t>(time), priority);
+            manager.addEvent(event);
+
+            Protocol::Writer writer(out, Protocol::STATUS_OK, requestId);
+            writer.i32(event.getId());
+            writer.finish();
+            return;
+        }
+        case Protocol::OP_REMOVE:
+        case Protocol::OP_COMPLETE:
+        case Protocol::OP_FIND: {
+            int32_t id = reader.i32();
+            if (!reader.ok()) break;
+
+            EventHandle handle = manager.findEvent(id);
+            const Event* event = manager.getEvent(handle);
+            if (event == nullptr) {
+                Protocol::Writer(out, Protocol::STATUS_NOT_FOUND, requestId).finish();
+                return;
+            }
+            Protocol::Writer writer(out, Protocol::STATUS_OK, requestId);
+            if (opcode == Protocol::OP_FIND) {
+                writer.event(*event);
+            } else if (opcode == Protocol::OP_REMOVE) {
+                manager.removeEvent(handle);
+            } else {
+                manager.markEventCompleted(handle);
+            }
+            writer.finish();
+            return;
+        }
+        case Protocol::OP_SEARCH: {
+            std::string text = reader.str();
+            if (!reader.ok()) break;
+            writeEvents(manager.searchByTitle(text), requestId, out);
+            return;
+        }
+        case Protocol::OP_DUE:
+            writeEvents(manager.getDueReminders(), requestId, out);
+            return;
+        case Protocol::OP_UPCOMING: {
+            int32_t hours = reader.i32();
+            if (!reader.ok()) break;
+            writeEvents(manager.getUpcomingReminders(hours), requestId, out);
+            return;
+        }
+        default:
+            Protocol::Writer(out, Protocol::STATUS_BAD_REQUEST, requestId).finish();
+            return;
+    }
+
+    // PING answers OK; anything that fell out of the switch is malformed
+    uint8_t status = (opcode == Protocol::OP_PING) ? Protocol::STATUS_OK : Protocol::STATUS_BAD_REQUEST;
+    Protocol::Writer(out, status, requestId).finish();
+}
+
+bool EventServer::processFrames(Connection& connection) {
+    // Handle every complete frame buffered so far (pipelined requests), pausing
+    // while the client is slow to read its responses
+    bool heldBack = false;
+    while (true) {
+        if (connection.output.size() - connection.outputOffset >= OUTPUT_HIGH_WATER) {
+            heldBack = true;
+            break;
+        }
+        const char* data = connection.input.data() + connection.inputOffset;
+        size_t available = connection.input.size() - connection.inputOffset;
+        size_t size = Protocol::frameSize(data, available);
+        if (size == 0) break;
+        if (size == SIZE_MAX) {
+            // Unrecoverable framing error: drop the rest of the stream
+            connection.input.clear();
+            connection.inputOffset = 0;
+            Protocol::Writer(connection.output, Protocol::STATUS_BAD_REQUEST, 0).finish();
+            return false;
+        }
+
+        uint8_t opcode = static_cast<uint8_t>(data[4]);
+        uint32_t requestId;
+        std::memcpy(&requestId, data + 5, sizeof(requestId));
+        Protocol::Reader reader(data + Protocol::HEADER_SIZE, size - Protocol::HEADER_SIZE);
+        handleRequest(opcode, requestId, reader, connection.output);
+        connection.inputOffset += size;
+    }
+
+    // Compact the input buffer once consumed data dominates it
+    if (connection.inputOffset == connection.input.size()) {
+        connection.input.clear();
+        connection.inputOffset = 0;
+    } else if (connection.inputOffset > READ_CHUNK) {
+        connection.input.erase(0, connection.inputOffset);
+        connection.inputOffset = 0;
+    }
+    return heldBack;
+}
+
+#ifdef __linux__
+
+bool EventServer::openSocket() {
+    if (config.socketPath.size() >= sizeof(sockaddr_un::sun_path)) {
+        std::cerr << "Error: Socket path too long: " << config.socketPath << std::endl;
+        return false;
+    }
+
+    listenFd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd < 0) {
+        std::cerr << "Error: Could not create socket: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, config.socketPath.c_str(), sizeof(address.sun_path) - 1);
+    ::unlink(config.socketPath.c_str());
+
+    if (::bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+        ::listen(listenFd, SOMAXCONN) < 0) {
+        std::cerr << "Error: Could not listen on " << config.socketPath << ": "
+                  << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+    epoll_event event;
+    std::memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = listenFd;
+    if (epollFd < 0 || ::epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event) < 0) {
+        std::cerr << "Error: Could not set up epoll: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void EventServer::acceptClients() {
+    while (true) {
+        int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return; // EAGAIN: drained the backlog
+
+        epoll_event event;
+        std::memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN | EPOLLRDHUP;
+        event.data.fd = fd;
+        if (::epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) < 0) {
+            ::close(fd);
+            continue;
+        }
+        Connection connection;
+        connection.interest = event.events;
+        connections[fd] = connection;
+    }
+}
+
+bool EventServer::readClient(int fd, Connection& connection) {
+    // Leave the rest in the socket once the buffer is full; level-triggered
+    // epoll reports it again after the buffered frames are handled
+    while (connection.input.size() - connection.inputOffset < MAX_INPUT_BUFFER) {
+        size_t used = connection.input.size();
+        connection.input.resize(used + READ_CHUNK);
+        ssize_t received = ::read(fd, &connection.input[used], READ_CHUNK);
+        connection.input.resize(used + (received > 0 ? received : 0));
+
+        if (received > 0) continue;
+        if (received == 0) {
+            connection.peerClosed = true; // Answer what it sent before closing
+            return true;
+        }
+        if (errno == EINTR) continue;
+        return errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+    return true;
+}
+
+bool EventServer::writeClient(int fd, Connection& connection) {
+    while (connection.outputOffset < connection.output.size()) {
+        ssize_t written = ::write(fd, connection.output.data() + connection.outputOffset,
+                                  connection.output.size() - connection.outputOffset);
+        if (written > 0) {
+            connection.outputOffset += written;
+            continue;
+        }
+        if (written < 0 && errno == EINTR) continue;
+        if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        return false;
+    }
+
+    if (connection.outputOffset == connection.output.size()) {
+        connection.output.clear();
+        connection.outputOffset = 0;
+    } else if (connection.outputOffset > OUTPUT_HIGH_WATER) {
+        connection.output.erase(0, connection.outputOffset);
+        connection.outputOffset = 0;
+    }
+    return true;
+}
+
+void EventServer::updateInterest(int fd, Connection& connection) {
+    // Only watch for writability while a response is still pending, and stop
+    // reading while the client is not keeping up with its responses
+    size_t pending = connection.output.size() - connection.outputOffset;
+    uint32_t interest = 0;
+    if (!connection.peerClosed && pending < OUTPUT_HIGH_WATER) interest |= EPOLLIN | EPOLLRDHUP;
+    if (pending > 0) interest |= EPOLLOUT;
+    if (interest == connection.interest) return;
+
+    epoll_event event;
+    std::memset(&event, 0, sizeof(event));
+    event.events = interest;
+    event.data.fd = fd;
+    ::epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &event);
+    connection.interest = interest;
+}
+
+void EventServer::closeClient(int fd) {
+    ::epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    ::close(fd);
+    connections.erase(fd);
+}
+
+bool EventServer::run() {
+    if (!openSocket()) return false;
+
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_handler = requestStop;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    std::cout << "Serving " << manager.getEventCount() << " event(s) on "
+              << config.socketPath << " (Ctrl+C to stop)" << std::endl;
+
+    epoll_event events[MAX_EPOLL_EVENTS];
+    std::time_t lastSave = std::time(nullptr);
+
+    while (!stopRequested) {
+        int ready = ::epoll_wait(epollFd, events, MAX_EPOLL_EVENTS, 1000);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "Error: epoll_wait failed: " << std::strerror(errno) << std::endl;
+            break;
+        }
+
+        for (int i = 0; i < ready; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == listenFd) {
+                acceptClients();
+                continue;
+            }
+
+            auto it = connections.find(fd);
+            if (it == connections.end()) continue;
+            Connection& connection = it->second;
+
+            bool open = !(events[i].events & EPOLLERR);
+            if (open && (connection.interest & EPOLLIN) &&
+                (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP))) {
+                open = readClient(fd, connection);
+            }
+            // Alternate handling requests and writing responses until the client
+            // stops draining them or no held-back requests remain
+            while (open) {
+                bool heldBack = processFrames(connection);
+                open = writeClient(fd, connection);
+                if (!heldBack || connection.output.size() - connection.outputOffset >= OUTPUT_HIGH_WATER) break;
+            }
+            // A half-closed peer is answered in full before the socket is closed
+            if (!open || (connection.peerClosed && connection.output.empty())) {
+                closeClient(fd);
+                continue;
+            }
+            updateInterest(fd, connection);
+        }
+
+        std::time_t now = std::time(nullptr);
+        if (dirty && now - lastSave >= config.saveIntervalSeconds) {
+            persist();
+            lastSave = now;
+        }
+    }
+
+    persist();
+    bool saved = snapshotWriter.flush();
+    CommitStats stats = snapshotWriter.getStats();
+    std::cout << "\nServer stopped. " << stats.commits << " save(s), "
+              << (stats.commits > 0 ? stats.totalSeconds * 1000 / stats.commits : 0) << " ms average, "
+              << stats.maxSeconds * 1000 << " ms longest" << std::endl;
+    if (!saved) {
+        std::cerr << "Error: The last changes could not be saved to " << config.dataFile << std::endl;
+    }
+    return true;
+}
+
+#else
+
+bool EventServer::openSocket() { return false; }
+void EventServer::acceptClients() {}
+bool EventServer::readClient(int, Connection&) { return false; }
+bool EventServer::writeClient(int, Connection&) { return false; }
+void EventServer::closeClient(int) {}
+void EventServer::updateInterest(int, Connection&) {}
+
+bool EventServer::run() {
+    (void)requestStop;
+    std::cerr << "Server mode is only available on Linux." << std::endl;
+    return false;
+}
+
+#endif
@@ -1,108 +1,620 @@
 #include "../include/FileHandler.h"
+#include "../include/BackupStore.h"
+#include "../include/Checksum.h"
+#include "../include/Compression.h"
+#include "../include/FileSync.h"
+#include "../include/Parallel.h"
 #include <fstream>
 #include <iostream>
+#include <cstring>
+#include <cctype>
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <cstdio>
 
-FileHandler::FileHandler(const std::string& filename) : filename(filename) {}
+namespace {
+
+// Layout magics; as a pre-checksum plain file's event count either would be absurd
+const char PLAIN_MAGIC[8] = {'E', 'V', 'R', 'E', 'C', '0', '0', '2'};
+const char COMPRESSED_MAGIC[8] = {'E', 'V', 'Z', 'B', 'L', 'K', '0', '2'};
+const char LEGACY_COMPRESSED_MAGIC[8] = {'E', 'V', 'Z', 'B', 'L', 'K', '0', '1'};
+const char BLOCK_MAGIC[4] = {'B', 'L', 'K', '2'};
+const size_t MAGIC_SIZE = sizeof(PLAIN_MAGIC);
+
+const size_t BLOCK_TARGET = 128 * 1024; // Raw record bytes per block
+const size_t READ_CHUNK = 8 * 1024 * 1024; // Plain files are read this much at a time
+const size_t MAX_RECORD = 1024 * 1024; // Longer records are taken for damage when recovering
+const size_t BLOCK_HEADER_SIZE = sizeof(BLOCK_MAGIC) + 4 * 5;
+const size_t INDEX_ENTRY_SIZE = 8 + 4 * 4;
+const size_t FOOTER_SIZE = 8 + 4 + 8 + 4 + MAGIC_SIZE;
+const size_t LEGACY_INDEX_ENTRY_SIZE = 8 + 4 + 4 + 4;
+const size_t LEGACY_FOOTER_SIZE = 8 + 4 + 8 + MAGIC_SIZE;
+
+struct BlockEntry {
+    uint64_t offset; // First stored byte
+    uint32_t storedSize;
+    uint32_t rawSize;
+    uint32_t recordCount;
+    uint32_t storedCrc;
+};
+
+template <typename T>
+void writeField(std::string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+T readField(const char*& in) {
+    T value;
+    std::memcpy(&value, in, sizeof(value));
+    in += sizeof(value);
+    return value;
+}
+
+void appendRecord(std::string& out, const Event& event) {
+    std::string serialized = event.serialize();
+    writeField(out, static_cast<uint32_t>(serialized.size()));
+    writeField(out, Checksum::crc32c(serialized.data(), serialized.size()));
+    out += serialized;
+}
+
+// Where one serialized event sits; offset is its frame's position in the file
+// (or in the decompressed block)
+struct RecordSpan {
+    const char* data;
+    uint32_t length;
+    uint32_t crc;
+    uint64_t offset;
+};
+
+// A record that failed verification or parsing
+struct RecordFailure {
+    size_t index;
+    const char* reason;
+};
+
+// Checked records are [u32 length][u32 crc][data]; older files used [size_t length][data]
+size_t frameSize(bool checked) {
+    return checked ? 8 : sizeof(size_t);
+}
+
+// Reads the frame at data; false if it doesn't fit in size bytes
+bool readFrame(const char* data, size_t size, bool checked, RecordSpan& span) {
+    size_t header = frameSize(checked);
+    if (size < header) return false;
+    uint64_t length;
+    if (checked) {
+        uint32_t shortLength;
+        std::memcpy(&shortLength, data, 4);
+        std::memcpy(&span.crc, data + 4, 4);
+        length = shortLength;
+    } else {
+        size_t longLength;
+        std::memcpy(&longLength, data, sizeof(longLength));
+        length = longLength;
+        span.crc = 0;
+    }
+    if (length > size - header || length > UINT32_MAX) return false;
+    span.data = data + header;
+    span.length = static_cast<uint32_t>(length);
+    return true;
+}
+
+// Finds up to maxCount whole records at the start of data; returns the bytes
+// they cover. Checksums are left to parseRecords.
+size_t splitRecords(const char* data, size_t size, size_t maxCount, bool checked, uint64_t baseOffset,
+                    std::vector<RecordSpan>& out) {
+    size_t pos = 0;
+    RecordSpan span;
+    for (size_t found = 0; found < maxCount && readFrame(data + pos, size - pos, checked, span); ++found) {
+        span.offset = baseOffset + pos;
+        out.push_back(span);
+        pos += frameSize(checked) + span.length;
+    }
+    return pos;
+}
+
+void parseRange(const std::vector<RecordSpan>& records, size_t begin, size_t end, bool checked,
+                std::vector<Event>& out, std::vector<RecordFailure>& failures) {
+    for (size_t i = begin; i < end; ++i) {
+        const RecordSpan& record = records[i];
+        if (checked && Checksum::crc32c(record.data, record.length) != record.crc) {
+            failures.push_back(RecordFailure{i, "checksum mismatch"});
+            continue;
+        }
+        try {
+            out.push_back(Event::deserialize(std::string(record.data, record.length)));
+        } catch (const std::exception&) {
+            failures.push_back(RecordFailure{i, "unreadable record"});
+        }
+    }
+}
+
+// Verifies and deserializes records in parallel slices, each into its own
+// vector, then appends them to out in file order. Records that fail are left
+// out and listed in failures.
+void parseRecords(const std::vector<RecordSpan>& records, bool checked, std::vector<Event>& out,
+                  std::vector<RecordFailure>& failures) {
+    size_t slices = std::min(records.size(), static_cast<size_t>(Parallel::workerCount(records.size())) * 4);
+    std::vector<std::vector<Event>> parsed(slices);
+    std::vector<std::vector<RecordFailure>> failed(slices);
+    Parallel::forEach(slices, [&](size_t slice) {
+        size_t begin = records.size() * slice / slices;
+        size_t end = records.size() * (slice + 1) / slices;
+        parsed[slice].reserve(end - begin);
+        parseRange(records, begin, end, checked, parsed[slice], failed[slice]);
+    });
+    for (size_t slice = 0; slice < slices; ++slice) {
+        out.insert(out.end(), std::make_move_iterator(parsed[slice].begin()),
+                   std::make_move_iterator(parsed[slice].end()));
+        failures.insert(failures.end(), failed[slice].begin(), failed[slice].end());
+    }
+}
+
+// Cheap test for where a record might start, so resyncing only checksums
+// plausible candidates: a serialized event opens with its numeric ID
+bool plausibleRecord(const char* data, size_t size, bool checked, RecordSpan& span) {
+    if (!readFrame(data, size, checked, span) || span.length == 0 || span.length > MAX_RECORD) return false;
+    size_t digits = 0;
+    while (digits < span.length && digits < 12 && std::isdigit(static_cast<unsigned char>(span.data[digits]))) {
+        ++digits;
+    }
+    if (digits == 0 || digits == span.length || span.data[digits] != '|') return false;
+    return !checked || Checksum::crc32c(span.data, span.length) == span.crc;
+}
+
+// Reads a block header at data; false if it is not a whole, intact one
+bool readBlockHeader(const char* data, size_t size, BlockEntry& block) {
+    if (size < BLOCK_HEADER_SIZE || std::memcmp(data, BLOCK_MAGIC, sizeof(BLOCK_MAGIC)) != 0) return false;
+    const char* in = data + sizeof(BLOCK_MAGIC);
+    block.storedSize = readField<uint32_t>(in);
+    block.rawSize = readField<uint32_t>(in);
+    block.recordCount = readField<uint32_t>(in);
+    block.storedCrc = readField<uint32_t>(in);
+    uint32_t headerCrc = readField<uint32_t>(in);
+    return headerCrc == Checksum::crc32c(data, BLOCK_HEADER_SIZE - 4) &&
+           block.storedSize <= size - BLOCK_HEADER_SIZE;
+}
+
+} // namespace
+
+FileHandler::FileHandler(const std::string& filename)
+    : filename(filename), compressed(false), recovery(false), syncWrites(true) {}
+
+bool FileHandler::commitFile(std::ofstream& file, const std::string& temp) const {
+    file.close();
+    if (!file) {
+        std::cerr << "Error: Failed to write data file: " << temp << std::endl;
+        std::remove(temp.c_str());
+        return false;
+    }
+    // The data must be on disk before the rename can make it the data file
+    if (syncWrites && !FileSync::syncFile(temp)) {
+        std::cerr << "Error: Could not flush " << temp << " to disk" << std::endl;
+        std::remove(temp.c_str());
+        return false;
+    }
+    if (!FileSync::replaceFile(temp, filename, syncWrites)) {
+        std::cerr << "Error: Could not replace data file: " << filename << std::endl;
+        std::remove(temp.c_str());
+        return false;
+    }
+    return true;
+}
 
 bool FileHandler::saveEvents(const EventManager& manager) {
-    std::ofstream file(filename, std::ios::binary);
+    return saveSnapshot(manager.snapshot());
+}
+
+bool FileHandler::saveSnapshot(const PersistentEventMap& snapshot) const {
+    if (compressed) return saveCompressed(snapshot);
+    
+    std::string temp = tempName();
+    std::ofstream file(temp, std::ios::binary | std::ios::trunc);
     if (!file.is_open()) {
-        std::cerr << "Error: Could not open file for writing: " << filename << std::endl;
+        std::cerr << "Error: Could not open file for writing: " << temp << std::endl;
         return false;
     }
     
-    std::vector<Event> events = manager.getAllEvents();
-    
-    // Write number of events
-    size_t eventCount = events.size();
-    file.write(reinterpret_cast<const char*>(&eventCount), sizeof(eventCount));
+    std::string out(PLAIN_MAGIC, MAGIC_SIZE);
+    writeField(out, static_cast<uint64_t>(snapshot.size()));
     
-    // Write each event
-    for (const Event& event : events) {
-        std::string serialized = event.serialize();
-        size_t length = serialized.length();
-        file.write(reinterpret_cast<const char*>(&length), sizeof(length));
-        file.write(serialized.c_str(), length);
-    }
-    
-    file.close();
-    return true;
+    // Write each event, handing records to the stream in large pieces
+    snapshot.forEach([&](const Event& event) {
+        appendRecord(out, event);
+        if (out.size() >= BLOCK_TARGET) {
+            file.write(out.data(), out.size());
+            out.clear();
+        }
+    });
+    file.write(out.data(), out.size());
+    return commitFile(file, temp);
 }
 
-bool FileHandler::loadEvents(EventManager& manager) {
-    std::ifstream file(filename, std::ios::binary);
+bool FileHandler::saveCompressed(const PersistentEventMap& snapshot) const {
+    std::string temp = tempName();
+    std::ofstream file(temp, std::ios::binary | std::ios::trunc);
     if (!file.is_open()) {
-        std::cout << "No existing data file found. Starting with empty event list." << std::endl;
-        return true; // Not an error, just no existing data
+        std::cerr << "Error: Could not open file for writing: " << temp << std::endl;
+        return false;
+    }
+    
+    file.write(COMPRESSED_MAGIC, MAGIC_SIZE);
+    std::vector<BlockEntry> blocks;
+    std::string raw;
+    std::string stored;
+    std::string header;
+    uint64_t offset = MAGIC_SIZE;
+    uint32_t records = 0;
+    
+    auto writeBlock = [&]() {
+        if (records == 0) return;
+        stored.clear();
+        Compression::compress(raw.data(), raw.size(), stored);
+        BlockEntry block{offset + BLOCK_HEADER_SIZE, static_cast<uint32_t>(stored.size()),
+                         static_cast<uint32_t>(raw.size()), records,
+                         Checksum::crc32c(stored.data(), stored.size())};
+        
+        // Each block describes itself too, so recovery can find blocks without the index
+        header.assign(BLOCK_MAGIC, sizeof(BLOCK_MAGIC));
+        writeField(header, block.storedSize);
+        writeField(header, block.rawSize);
+        writeField(header, block.recordCount);
+        writeField(header, block.storedCrc);
+        writeField(header, Checksum::crc32c(header.data(), header.size()));
+        file.write(header.data(), header.size());
+        file.write(stored.data(), stored.size());
+        
+        blocks.push_back(block);
+        offset += header.size() + stored.size();
+        raw.clear();
+        records = 0;
+    };
+    
+    snapshot.forEach([&](const Event& event) {
+        appendRecord(raw, event);
+        records++;
+        if (raw.size() >= BLOCK_TARGET) writeBlock();
+    });
+    writeBlock();
+    
+    std::string tail;
+    for (const BlockEntry& block : blocks) {
+        writeField(tail, block.offset);
+        writeField(tail, block.storedSize);
+        writeField(tail, block.rawSize);
+        writeField(tail, block.recordCount);
+        writeField(tail, block.storedCrc);
     }
+    uint32_t indexCrc = Checksum::crc32c(tail.data(), tail.size());
+    writeField(tail, offset); // Where the index starts
+    writeField(tail, static_cast<uint32_t>(blocks.size()));
+    writeField(tail, static_cast<uint64_t>(snapshot.size()));
+    writeField(tail, indexCrc);
+    tail.append(COMPRESSED_MAGIC, MAGIC_SIZE);
+    file.write(tail.data(), tail.size());
+    return commitFile(file, temp);
+}
+
+bool FileHandler::damaged(uint64_t offset, uint64_t length, const std::string& reason) {
+    report.damage.push_back(DamagedRegion{offset, length, reason});
+    if (recovery) return true;
+    std::cerr << "Error: " << filename << " is damaged at byte " << offset << " (" << reason << ")."
+              << " Load it in recovery mode to keep the readable events." << std::endl;
+    return false;
+}
+
+void FileHandler::finishLoad(std::vector<Event>& events, EventManager& manager) {
+    manager.addEvents(events);
+    report.loaded = events.size();
     
+    if (report.damage.empty() && report.loaded == report.expected) {
+        std::cout << "Successfully loaded " << report.loaded << " events from file." << std::endl;
+        return;
+    }
+    std::sort(report.damage.begin(), report.damage.end(),
+              [](const DamagedRegion& a, const DamagedRegion& b) { return a.offset < b.offset; });
+    std::cout << "Recovered " << report.loaded << " of " << report.expected << " events from " << filename
+              << "; skipped " << report.damage.size() << " damaged region(s):" << std::endl;
+    for (const DamagedRegion& region : report.damage) {
+        std::cout << "  byte " << region.offset << ", " << region.length << " bytes: " << region.reason << std::endl;
+    }
+}
+
+bool FileHandler::loadPlain(std::ifstream& file, bool checked, EventManager& manager) {
+    uint64_t bufferOffset = static_cast<uint64_t>(file.tellg());
     try {
         // Read number of events
-        size_t eventCount;
+        uint64_t eventCount;
         file.read(reinterpret_cast<char*>(&eventCount), sizeof(eventCount));
         
         if (file.fail()) {
             std::cerr << "Error reading event count from file." << std::endl;
-            file.close();
             return false;
         }
+        report.expected = static_cast<size_t>(eventCount);
+        bufferOffset += sizeof(eventCount);
         
-        // Read each event
-        for (size_t i = 0; i < eventCount; ++i) {
-            size_t length;
-            file.read(reinterpret_cast<char*>(&length), sizeof(length));
+        // Read large chunks, cut them at record boundaries and verify and
+        // parse each chunk's records in parallel; a partial record carries over
+        std::vector<Event> events;
+        events.reserve(eventCount < READ_CHUNK ? eventCount : READ_CHUNK);
+        std::vector<RecordSpan> records;
+        std::vector<RecordFailure> failures;
+        std::string buffer;
+        size_t remaining = eventCount;
+        while (remaining > 0) {
+            size_t carried = buffer.size();
+            buffer.resize(carried + READ_CHUNK);
+            file.read(&buffer[carried], READ_CHUNK);
+            buffer.resize(carried + static_cast<size_t>(file.gcount()));
             
-            if (file.fail()) {
-                std::cerr << "Error reading event length from file." << std::endl;
-                file.close();
-                return false;
+            records.clear();
+            size_t consumed = splitRecords(buffer.data(), buffer.size(), remaining, checked, bufferOffset, records);
+            if (records.empty() && file.gcount() == 0) {
+                return damaged(bufferOffset, buffer.size(), "file ends after " + std::to_string(events.size()) +
+                               " of " + std::to_string(eventCount) + " events");
             }
             
-            std::string serialized(length, '\0');
-            file.read(&serialized[0], length);
-            
-            if (file.fail()) {
-                std::cerr << "Error reading event data from file." << std::endl;
-                file.close();
-                return false;
+            parseRecords(records, checked, events, failures);
+            if (!failures.empty()) {
+                const RecordSpan& record = records[failures.front().index];
+                return damaged(record.offset, frameSize(checked) + record.length, failures.front().reason);
             }
-            
-            Event event = Event::deserialize(serialized);
-            manager.addEvent(event);
+            remaining -= records.size();
+            buffer.erase(0, consumed);
+            bufferOffset += consumed;
         }
         
-        file.close();
-        std::cout << "Successfully loaded " << eventCount << " events from file." << std::endl;
+        finishLoad(events, manager);
         return true;
         
     } catch (const std::exception& e) {
         std::cerr << "Error loading events: " << e.what() << std::endl;
-        file.close();
         return false;
     }
 }
 
-bool FileHandler::fileExists() const {
-    std::ifstream file(filename);
-    return file.good();
+bool FileHandler::recoverPlain(const std::string& data, bool checked, EventManager& manager) {
+    size_t pos = checked ? MAGIC_SIZE : 0;
+    if (data.size() < pos + sizeof(uint64_t)) {
+        damaged(0, data.size(), "file too short for a header");
+        std::vector<Event> none;
+        finishLoad(none, manager);
+        return true;
+    }
+    const char* countField = data.data() + pos;
+    report.expected = static_cast<size_t>(readField<uint64_t>(countField));
+    pos += sizeof(uint64_t);
+    
+    // Walk record by record; on damage, scan ahead byte by byte for the next
+    // record that checks out. Old files have no checksums to resync on, so
+    // there the walk stops at the first bad length.
+    std::vector<RecordSpan> records;
+    RecordSpan span;
+    while (pos < data.size()) {
+        if (plausibleRecord(data.data() + pos, data.size() - pos, checked, span)) {
+            span.offset = pos;
+            records.push_back(span);
+            pos += frameSize(checked) + span.length;
+            continue;
+        }
+        if (!checked) {
+            damaged(pos, data.size() - pos, "unreadable or truncated record; rest of file skipped");
+            break;
+        }
+        size_t next = pos + 1;
+        while (next < data.size() && !plausibleRecord(data.data() + next, data.size() - next, checked, span)) {
+            ++next;
+        }
+        damaged(pos, next - pos, next < data.size() ? "checksum mismatch" : "truncated record");
+        pos = next;
+    }
+    
+    // The walk has verified the checksums already
+    std::vector<Event> events;
+    std::vector<RecordFailure> failures;
+    parseRecords(records, false, events, failures);
+    for (const RecordFailure& failure : failures) {
+        const RecordSpan& record = records[failure.index];
+        damaged(record.offset, frameSize(checked) + record.length, failure.reason);
+    }
+    if (report.damage.empty() && events.size() < report.expected) {
+        damaged(data.size(), 0, "file ends after " + std::to_string(events.size()) + " of " +
+                std::to_string(report.expected) + " events");
+    }
+    
+    finishLoad(events, manager);
+    return true;
 }
 
-bool FileHandler::createBackup() const {
-    if (!fileExists()) return false;
+bool FileHandler::loadCompressed(const std::string& data, bool checked, EventManager& manager) {
+    size_t entrySize = checked ? INDEX_ENTRY_SIZE : LEGACY_INDEX_ENTRY_SIZE;
+    size_t footerSize = checked ? FOOTER_SIZE : LEGACY_FOOTER_SIZE;
+    const char* magic = checked ? COMPRESSED_MAGIC : LEGACY_COMPRESSED_MAGIC;
+    std::vector<BlockEntry> blocks;
     
-    std::string backupName = filename + ".backup";
-    std::ifstream src(filename, std::ios::binary);
-    std::ofstream dst(backupName, std::ios::binary);
+    // The index, if it is intact, says where every block is
+    bool indexed = false;
+    if (data.size() >= MAGIC_SIZE + footerSize &&
+        std::memcmp(data.data() + data.size() - MAGIC_SIZE, magic, MAGIC_SIZE) == 0) {
+        const char* footer = data.data() + data.size() - footerSize;
+        uint64_t indexOffset = readField<uint64_t>(footer);
+        uint32_t blockCount = readField<uint32_t>(footer);
+        uint64_t eventCount = readField<uint64_t>(footer);
+        uint32_t indexCrc = checked ? readField<uint32_t>(footer) : 0;
+        uint64_t indexSize = static_cast<uint64_t>(blockCount) * entrySize;
+        
+        indexed = indexOffset >= MAGIC_SIZE && indexOffset + indexSize + footerSize == data.size() &&
+                  (!checked || Checksum::crc32c(data.data() + indexOffset, indexSize) == indexCrc);
+        const char* index = data.data() + indexOffset;
+        for (uint32_t i = 0; indexed && i < blockCount; ++i) {
+            BlockEntry block;
+            block.offset = readField<uint64_t>(index);
+            block.storedSize = readField<uint32_t>(index);
+            block.rawSize = readField<uint32_t>(index);
+            block.recordCount = readField<uint32_t>(index);
+            block.storedCrc = checked ? readField<uint32_t>(index) : 0;
+            indexed = block.offset >= MAGIC_SIZE && block.offset + block.storedSize <= indexOffset;
+            blocks.push_back(block);
+        }
+        if (indexed) report.expected = static_cast<size_t>(eventCount);
+    }
     
-    if (!src.is_open() || !dst.is_open()) {
-        return false;
+    if (!indexed) {
+        blocks.clear();
+        // When recovering a checked file the walk below reports the index area itself
+        if ((!recovery || !checked) &&
+            !damaged(data.size() < footerSize ? 0 : data.size() - footerSize, std::min(data.size(), footerSize),
+                     "block index unreadable")) {
+            return false;
+        }
+        
+        // Find the blocks from their own headers instead, skipping what lies between
+        size_t pos = MAGIC_SIZE;
+        BlockEntry block;
+        while (checked && pos < data.size()) {
+            if (readBlockHeader(data.data() + pos, data.size() - pos, block)) {
+                block.offset = pos + BLOCK_HEADER_SIZE;
+                blocks.push_back(block);
+                report.expected += block.recordCount;
+                pos = block.offset + block.storedSize;
+                continue;
+            }
+            size_t next = pos + 1;
+            while (next < data.size() && !readBlockHeader(data.data() + next, data.size() - next, block)) {
+                ++next;
+            }
+            damaged(pos, next - pos, next < data.size() ? "unreadable bytes between blocks"
+                                                        : "trailing bytes (index or partial block)");
+            pos = next;
+        }
     }
     
-    dst << src.rdbuf();
+    // Blocks are independent, so each task verifies, decompresses and parses one
+    std::vector<std::vector<Event>> parsed(blocks.size());
+    std::vector<std::vector<RecordFailure>> failed(blocks.size());
+    std::vector<const char*> blockDamage(blocks.size(), nullptr);
+    Parallel::forEach(blocks.size(), [&](size_t i) {
+        const BlockEntry& block = blocks[i];
+        if (checked && Checksum::crc32c(data.data() + block.offset, block.storedSize) != block.storedCrc) {
+            blockDamage[i] = "block checksum mismatch";
+            return;
+        }
+        std::string raw;
+        raw.reserve(block.rawSize);
+        if (!Compression::decompress(data.data() + block.offset, block.storedSize, block.rawSize, raw)) {
+            blockDamage[i] = "undecodable block";
+            return;
+        }
+        std::vector<RecordSpan> records;
+        if (splitRecords(raw.data(), raw.size(), block.recordCount, checked, 0, records) != raw.size() ||
+            records.size() != block.recordCount) {
+            blockDamage[i] = "bad record framing in block";
+            return;
+        }
+        parsed[i].reserve(records.size());
+        parseRange(records, 0, records.size(), checked, parsed[i], failed[i]);
+    });
+    
+    std::vector<Event> events;
+    events.reserve(report.expected);
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        uint64_t start = checked ? blocks[i].offset - BLOCK_HEADER_SIZE : blocks[i].offset;
+        uint64_t length = blocks[i].offset + blocks[i].storedSize - start;
+        if (blockDamage[i] && !damaged(start, length, blockDamage[i])) return false;
+        for (const RecordFailure& failure : failed[i]) {
+            if (!damaged(start, length, std::string(failure.reason) + " (record " +
+                         std::to_string(failure.index) + " of block)")) {
+                return false;
+            }
+        }
+        events.insert(events.end(), std::make_move_iterator(parsed[i].begin()),
+                      std::make_move_iterator(parsed[i].end()));
+        std::vector<Event>().swap(parsed[i]); // Release as we go
+    }
+    
+    compressed = true; // Keep the layout the file was written in
+    finishLoad(events, manager);
     return true;
 }
 
-bool FileHandler::restoreFromBackup() {
+bool FileHandler::loadEvents(EventManager& manager) {
+    report = LoadReport();
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cout << "No existing data file found. Starting with empty event list." << std::endl;
+        return true; // Not an error, just no existing data
+    }
+    
+    char magic[MAGIC_SIZE];
+    bool hasMagic = static_cast<bool>(file.read(magic, sizeof(magic)));
+    bool compressedFile = hasMagic && (std::memcmp(magic, COMPRESSED_MAGIC, MAGIC_SIZE) == 0 ||
+                                       std::memcmp(magic, LEGACY_COMPRESSED_MAGIC, MAGIC_SIZE) == 0);
+    bool checked = hasMagic && (std::memcmp(magic, PLAIN_MAGIC, MAGIC_SIZE) == 0 ||
+                                std::memcmp(magic, COMPRESSED_MAGIC, MAGIC_SIZE) == 0);
+    
+    // Compressed files and recovery need the whole file at hand
+    if (compressedFile || recovery) {
+        file.clear();
+        file.seekg(0, std::ios::end);
+        std::string data(static_cast<size_t>(file.tellg()), '\0');
+        file.seekg(0);
+        if (!file.read(&data[0], data.size())) {
+            std::cerr << "Error: Could not read data file: " << filename << std::endl;
+            return false;
+        }
+        file.close();
+        try {
+            return compressedFile ? loadCompressed(data, checked, manager) : recoverPlain(data, checked, manager);
+        } catch (const std::exception& e) {
+            std::cerr << "Error loading events: " << e.what() << std::endl;
+            return false;
+        }
+    }
+    
+    file.clear();
+    file.seekg(checked ? MAGIC_SIZE : 0);
+    return loadPlain(file, checked, manager);
+}
+
+bool FileHandler::recoverEvents(EventManager& manager) {
+    int generation = createBackup();
+    if (generation == 0) {
+        std::cerr << "Error: Could not back up " << filename << "; not recovering over it." << std::endl;
+        return false;
+    }
+    std::cout << "Kept the damaged file as backup generation " << generation << "." << std::endl;
+    
+    manager.clear();
+    recovery = true;
+    bool loaded = loadEvents(manager);
+    recovery = false;
+    return loaded;
+}
+
+bool FileHandler::fileExists() const {
+    std::ifstream file(filename);
+    return file.good();
+}
+
+int FileHandler::createBackup() const {
+    if (!fileExists()) return 0;
+    BackupStore backups(filename);
+    backups.setSyncWrites(syncWrites);
+    return backups.create(std::time(nullptr));
+}
+
+bool FileHandler::restoreFromBackup(int generation) {
+    BackupStore backups(filename);
+    backups.setSyncWrites(syncWrites);
+    if (generation != 0 || !backups.list().empty()) {
+        return backups.restore(generation);
+    }
+    
+    // Single-copy backup left by older versions
     std::string backupName = filename + ".backup";
     std::ifstream src(backupName, std::ios::binary);
     std::ofstream dst(filename, std::ios::binary);
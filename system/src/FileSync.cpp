@@ -0,0 +1,54 @@
+#include "../include/FileSync.h"
+#include <cstdio>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+#ifdef __linux__
+#include <unistd.h>
+#include <fcntl.h>
+#endif
+
+namespace FileSync {
+
+#ifdef __linux__
+
+bool syncFile(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    bool synced = ::fdatasync(fd) == 0;
+    ::close(fd);
+    return synced;
+}
+
+bool syncParent(const std::string& path) {
+    size_t slash = path.rfind('/');
+    std::string directory = slash == std::string::npos ? "." : (slash == 0 ? "/" : path.substr(0, slash));
+    int fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd < 0) return false;
+    bool synced = ::fsync(fd) == 0;
+    ::close(fd);
+    return synced;
+}
+
+#else
+
+bool syncFile(const std::string&) { return true; }
+bool syncParent(const std::string&) { return true; }
+
+#endif
+
+bool replaceFile(const std::string& temp, const std::string& target, bool sync) {
+#ifdef _WIN32
+    (void)sync; // MOVEFILE_WRITE_THROUGH waits for the move to reach the disk
+    return MoveFileExA(temp.c_str(), target.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    if (std::rename(temp.c_str(), target.c_str()) != 0) return false;
+    if (sync) syncParent(target);
+    return true;
+#endif
+}
+
+} // namespace FileSync
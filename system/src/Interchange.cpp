@@ -0,0 +1,958 @@
+#include "../include/Interchange.h"
+#include <fstream>
+#include <iostream>
+#include <string_view>
+#include <deque>
+#include <vector>
+#include <cstring>
+#include <cctype>
+#include <ctime>
+#include <cstdio>
+#include <climits>
+
+namespace {
+
+typedef std::string_view Text;
+
+const size_t READ_CHUNK = 1024 * 1024;
+// A CSV record longer than this is taken to be broken (an unterminated quote
+// would otherwise hold the rest of the file in the carry-over buffer)
+const size_t MAX_CSV_RECORD = READ_CHUNK;
+const size_t WRITE_CHUNK = 1024 * 1024;
+const size_t BATCH_SIZE = 64 * 1024; // Events handed to the manager at once
+const size_t PAGE_SIZE = 4096;       // Events fetched per page when exporting
+const size_t FOLD_WIDTH = 75;        // iCalendar line limit in octets
+
+// ---- Text helpers
+
+char lower(char c) {
+    return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+}
+
+bool equalsIgnoreCase(Text text, const char* word) {
+    size_t length = std::strlen(word);
+    if (text.size() != length) return false;
+    for (size_t i = 0; i < length; ++i) {
+        if (lower(text[i]) != lower(word[i])) return false;
+    }
+    return true;
+}
+
+Text trim(Text text) {
+    while (!text.empty() && std::isspace(static_cast<unsigned char>(text.front()))) text.remove_prefix(1);
+    while (!text.empty() && std::isspace(static_cast<unsigned char>(text.back()))) text.remove_suffix(1);
+    return text;
+}
+
+// n decimal digits at text[pos]
+bool readDigits(Text text, size_t pos, size_t n, int& value) {
+    if (pos + n > text.size()) return false;
+    value = 0;
+    for (size_t i = pos; i < pos + n; ++i) {
+        if (!std::isdigit(static_cast<unsigned char>(text[i]))) return false;
+        value = value * 10 + (text[i] - '0');
+    }
+    return true;
+}
+
+// A run of digits at text[pos], advancing pos
+bool readNumber(Text text, size_t& pos, long long& value) {
+    size_t start = pos;
+    value = 0;
+    while (pos < text.size() && std::isdigit(static_cast<unsigned char>(text[pos])) && pos - start < 18) {
+        value = value * 10 + (text[pos++] - '0');
+    }
+    return pos > start;
+}
+
+bool parseWholeNumber(Text text, long long& value) {
+    size_t pos = 0;
+    return readNumber(text, pos, value) && pos == text.size();
+}
+
+// ---- Dates
+
+// Days since 1970-01-01 of a proleptic Gregorian date, and back
+long long daysFromCivil(int year, int month, int day) {
+    long long y = year - (month <= 2 ? 1 : 0);
+    long long era = (y >= 0 ? y : y - 399) / 400;
+    long long yearOfEra = y - era * 400;
+    long long dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    long long dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+void civilFromDays(long long days, int& year, int& month, int& day) {
+    days += 719468;
+    long long era = (days >= 0 ? days : days - 146096) / 146097;
+    long long dayOfEra = days - era * 146097;
+    long long yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    long long dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    long long shifted = (5 * dayOfYear + 2) / 153;
+    day = static_cast<int>(dayOfYear - (153 * shifted + 2) / 5 + 1);
+    month = static_cast<int>(shifted < 10 ? shifted + 3 : shifted - 9);
+    year = static_cast<int>(yearOfEra + era * 400 + (month <= 2 ? 1 : 0));
+}
+
+bool validDate(int year, int month, int day) {
+    return year >= 1900 && year <= 9999 && month >= 1 && month <= 12 && day >= 1 && day <= 31;
+}
+
+// Local wall-clock time to time_t. mktime would dominate a large import, so
+// each day's midnight is looked up once and reused while the day has no
+// daylight saving change.
+class LocalClock {
+private:
+    long long cachedDay = LLONG_MIN;
+    std::time_t midnight = 0;
+    bool regular = false;
+
+public:
+    bool toTime(int year, int month, int day, int hour, int minute, int second, std::time_t& out) {
+        long long days = daysFromCivil(year, month, day);
+        if (days != cachedDay) {
+            std::tm start = {};
+            start.tm_year = year - 1900;
+            start.tm_mon = month - 1;
+            start.tm_mday = day;
+            start.tm_isdst = -1;
+            std::tm next = start;
+            next.tm_mday++;
+            midnight = std::mktime(&start);
+            std::time_t nextMidnight = std::mktime(&next);
+            regular = midnight != -1 && start.tm_hour == 0 && nextMidnight - midnight == 86400;
+            cachedDay = days;
+        }
+        if (regular) {
+            out = midnight + hour * 3600 + minute * 60 + second;
+            return true;
+        }
+        std::tm exact = {};
+        exact.tm_year = year - 1900;
+        exact.tm_mon = month - 1;
+        exact.tm_mday = day;
+        exact.tm_hour = hour;
+        exact.tm_min = minute;
+        exact.tm_sec = second;
+        exact.tm_isdst = -1;
+        out = std::mktime(&exact);
+        return out != -1;
+    }
+};
+
+// "YYYYMMDD" (a date, taken as local midnight), "YYYYMMDDTHHMMSS" (local) or
+// "YYYYMMDDTHHMMSSZ" (UTC); times with a TZID are taken as local
+bool parseIcsTime(Text value, LocalClock& local, std::time_t& out) {
+    int year, month, day, hour = 0, minute = 0, second = 0;
+    if (!readDigits(value, 0, 4, year) || !readDigits(value, 4, 2, month) || !readDigits(value, 6, 2, day) ||
+        !validDate(year, month, day)) {
+        return false;
+    }
+    bool utc = false;
+    if (value.size() > 8) {
+        if (value.size() < 15 || value[8] != 'T' || !readDigits(value, 9, 2, hour) ||
+            !readDigits(value, 11, 2, minute) || !readDigits(value, 13, 2, second)) {
+            return false;
+        }
+        utc = value.size() == 16 && (value[15] == 'Z' || value[15] == 'z');
+        if (value.size() > 15 && !utc) return false;
+    }
+    if (utc) {
+        out = static_cast<std::time_t>(daysFromCivil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second);
+        return true;
+    }
+    return local.toTime(year, month, day, hour, minute, second, out);
+}
+
+// [+|-]P[nW][nD][T[nH][nM][nS]]
+bool parseIcsDuration(Text value, std::time_t& out) {
+    size_t pos = 0;
+    bool negative = false;
+    if (pos < value.size() && (value[pos] == '+' || value[pos] == '-')) negative = value[pos++] == '-';
+    if (pos >= value.size() || value[pos++] != 'P') return false;
+
+    long long total = 0;
+    bool inTime = false;
+    while (pos < value.size()) {
+        if (value[pos] == 'T') {
+            inTime = true;
+            ++pos;
+            continue;
+        }
+        long long number;
+        if (!readNumber(value, pos, number) || pos >= value.size()) return false;
+        char unit = value[pos++];
+        if (unit == 'W' && !inTime) total += number * 7 * 86400;
+        else if (unit == 'D' && !inTime) total += number * 86400;
+        else if (unit == 'H' && inTime) total += number * 3600;
+        else if (unit == 'M' && inTime) total += number * 60;
+        else if (unit == 'S' && inTime) total += number;
+        else return false;
+    }
+    out = static_cast<std::time_t>(negative ? -total : total);
+    return true;
+}
+
+// FREQ, INTERVAL, COUNT and UNTIL; BYDAY and friends are not supported and
+// leave the plain frequency
+bool parseRrule(Text value, LocalClock& local, RecurrenceRule& rule) {
+    RecurrenceRule parsed;
+    long long interval = 1;
+    long long unit = 1; // Seconds per step for sub-daily frequencies, months per step for yearly
+    while (!value.empty()) {
+        size_t end = value.find(';');
+        Text part = value.substr(0, end);
+        value = end == Text::npos ? Text() : value.substr(end + 1);
+        size_t equals = part.find('=');
+        if (equals == Text::npos) continue;
+        Text key = part.substr(0, equals);
+        Text setting = part.substr(equals + 1);
+
+        if (equalsIgnoreCase(key, "FREQ")) {
+            static const struct { const char* name; RecurrenceType type; long long unit; } frequencies[] = {
+                {"DAILY", RecurrenceType::Daily, 1}, {"WEEKLY", RecurrenceType::Weekly, 1},
+                {"MONTHLY", RecurrenceType::Monthly, 1}, {"YEARLY", RecurrenceType::Monthly, 12},
+                {"HOURLY", RecurrenceType::Interval, 3600}, {"MINUTELY", RecurrenceType::Interval, 60},
+                {"SECONDLY", RecurrenceType::Interval, 1}};
+            parsed.type = RecurrenceType::None;
+            for (const auto& frequency : frequencies) {
+                if (equalsIgnoreCase(setting, frequency.name)) {
+                    parsed.type = frequency.type;
+                    unit = frequency.unit;
+                }
+            }
+            if (!parsed.isRecurring()) return false;
+        } else if (equalsIgnoreCase(key, "INTERVAL")) {
+            if (!parseWholeNumber(setting, interval) || interval < 1) return false;
+        } else if (equalsIgnoreCase(key, "COUNT")) {
+            long long count;
+            if (!parseWholeNumber(setting, count)) return false;
+            parsed.count = static_cast<long>(count);
+        } else if (equalsIgnoreCase(key, "UNTIL")) {
+            if (!parseIcsTime(setting, local, parsed.until)) return false;
+        }
+    }
+    if (!parsed.isRecurring()) return false;
+    parsed.every = static_cast<long>(interval * unit);
+    rule = parsed;
+    return true;
+}
+
+// Undoes iCalendar TEXT escaping (\\ \; \, \n); copies only when needed
+Text unescapeIcs(Text value, std::string& scratch) {
+    if (value.find('\\') == Text::npos) return value;
+    scratch.clear();
+    for (size_t i = 0; i < value.size(); ++i) {
+        if (value[i] == '\\' && i + 1 < value.size()) {
+            char next = value[++i];
+            scratch += (next == 'n' || next == 'N') ? '\n' : next;
+        } else {
+            scratch += value[i];
+        }
+    }
+    return scratch;
+}
+
+// "YYYY-MM-DD" or "MM/DD/YYYY"
+bool parseCsvDate(Text text, int& year, int& month, int& day) {
+    text = trim(text);
+    if (text.size() >= 10 && text[4] == '-' && text[7] == '-') {
+        return readDigits(text, 0, 4, year) && readDigits(text, 5, 2, month) && readDigits(text, 8, 2, day) &&
+               validDate(year, month, day);
+    }
+    size_t pos = 0;
+    long long m, d, y;
+    if (!readNumber(text, pos, m) || pos >= text.size() || text[pos++] != '/' ||
+        !readNumber(text, pos, d) || pos >= text.size() || text[pos++] != '/' || !readNumber(text, pos, y)) {
+        return false;
+    }
+    year = static_cast<int>(y);
+    month = static_cast<int>(m);
+    day = static_cast<int>(d);
+    return validDate(year, month, day);
+}
+
+// "HH:MM", "HH:MM:SS", optionally followed by AM or PM; empty is midnight
+bool parseCsvClock(Text text, int& hour, int& minute, int& second) {
+    text = trim(text);
+    hour = minute = second = 0;
+    if (text.empty()) return true;
+
+    size_t pos = 0;
+    long long h, m, s = 0;
+    if (!readNumber(text, pos, h) || pos >= text.size() || text[pos++] != ':' || !readNumber(text, pos, m)) {
+        return false;
+    }
+    if (pos < text.size() && text[pos] == ':') {
+        ++pos;
+        if (!readNumber(text, pos, s)) return false;
+    }
+    Text suffix = trim(text.substr(pos));
+    if (equalsIgnoreCase(suffix, "PM") && h < 12) h += 12;
+    else if (equalsIgnoreCase(suffix, "AM") && h == 12) h = 0;
+    else if (!suffix.empty() && !equalsIgnoreCase(suffix, "AM") && !equalsIgnoreCase(suffix, "PM")) return false;
+
+    hour = static_cast<int>(h);
+    minute = static_cast<int>(m);
+    second = static_cast<int>(s);
+    return hour < 24 && minute < 60 && second < 61;
+}
+
+// 20250301T093000Z
+void appendUtc(std::string& out, std::time_t time) {
+    long long seconds = static_cast<long long>(time);
+    long long days = seconds >= 0 ? seconds / 86400 : -((-seconds + 86399) / 86400);
+    long long rest = seconds - days * 86400;
+    int year, month, day;
+    civilFromDays(days, year, month, day);
+    char text[24];
+    std::snprintf(text, sizeof(text), "%04d%02d%02dT%02d%02d%02dZ", year, month, day,
+                  static_cast<int>(rest / 3600), static_cast<int>(rest / 60 % 60), static_cast<int>(rest % 60));
+    out += text;
+}
+
+// ---- Import
+
+// Collects parsed events and hands them to the manager a batch at a time;
+// into an empty manager the first batch takes the bulk-load path
+class EventSink {
+private:
+    EventManager& manager;
+    std::vector<Event> batch;
+
+public:
+    InterchangeStats& stats;
+
+    EventSink(EventManager& manager, InterchangeStats& stats) : manager(manager), stats(stats) {
+        batch.reserve(BATCH_SIZE);
+    }
+
+    void add(Event&& event) {
+        batch.push_back(std::move(event));
+        stats.events++;
+        if (batch.size() >= BATCH_SIZE) flush();
+    }
+
+    void flush() {
+        if (batch.empty()) return;
+        manager.addEvents(batch);
+        batch.clear();
+    }
+};
+
+// iCalendar content lines -> events. consume() handles the complete logical
+// lines at the start of the data and returns how many bytes they took; a
+// line that may continue (folding) is left for the next call.
+class IcsImporter {
+private:
+    EventSink& sink;
+    LocalClock local;
+    int depth; // 1 inside a VEVENT, more inside a component nested in it
+    std::string unfolded;
+    std::string scratch;
+
+    std::string title;
+    std::string description;
+    std::time_t start, end, duration;
+    bool hasStart, hasEnd, hasDuration;
+    int priority;
+    bool completed;
+    bool cancelled;
+    RecurrenceRule rule;
+
+    void beginEvent() {
+        title.clear();
+        description.clear();
+        start = end = duration = 0;
+        hasStart = hasEnd = hasDuration = false;
+        priority = 2;
+        completed = cancelled = false;
+        rule = RecurrenceRule();
+    }
+
+    void endEvent() {
+        if (!hasStart || cancelled) {
+            sink.stats.skipped++;
+            return;
+        }
+        Event event(title.empty() ? "(No title)" : title, description, start, priority);
+        if (hasEnd && end > start) event.setDuration(end - start);
+        else if (hasDuration) event.setDuration(duration);
+        if (rule.isRecurring()) event.setRecurrence(rule);
+        event.setCompleted(completed);
+        sink.add(std::move(event));
+    }
+
+    void handleLine(Text line) {
+        // NAME[;PARAM=...]:VALUE, where quoted parameter values may contain ':'
+        size_t pos = 0;
+        while (pos < line.size() && line[pos] != ';' && line[pos] != ':') ++pos;
+        Text name = line.substr(0, pos);
+        bool quoted = false;
+        while (pos < line.size() && (quoted || line[pos] != ':')) {
+            if (line[pos] == '"') quoted = !quoted;
+            ++pos;
+        }
+        if (pos >= line.size()) return;
+        Text value = line.substr(pos + 1);
+
+        if (equalsIgnoreCase(name, "BEGIN")) {
+            if (depth > 0) {
+                depth++;
+            } else if (equalsIgnoreCase(value, "VEVENT")) {
+                depth = 1;
+                beginEvent();
+            }
+            return;
+        }
+        if (equalsIgnoreCase(name, "END")) {
+            if (depth > 1) {
+                depth--;
+            } else if (depth == 1 && equalsIgnoreCase(value, "VEVENT")) {
+                depth = 0;
+                endEvent();
+            }
+            return;
+        }
+        if (depth != 1) return;
+
+        if (equalsIgnoreCase(name, "SUMMARY")) {
+            title.assign(unescapeIcs(value, scratch));
+        } else if (equalsIgnoreCase(name, "DESCRIPTION")) {
+            description.assign(unescapeIcs(value, scratch));
+        } else if (equalsIgnoreCase(name, "DTSTART")) {
+            hasStart = parseIcsTime(value, local, start);
+        } else if (equalsIgnoreCase(name, "DTEND")) {
+            hasEnd = parseIcsTime(value, local, end);
+        } else if (equalsIgnoreCase(name, "DURATION")) {
+            hasDuration = parseIcsDuration(value, duration) && duration > 0;
+        } else if (equalsIgnoreCase(name, "PRIORITY")) {
+            // 1-4 high, 5 medium, 6-9 low; 0 means undefined
+            long long level;
+            if (parseWholeNumber(value, level) && level > 0) priority = level <= 4 ? 1 : (level == 5 ? 2 : 3);
+        } else if (equalsIgnoreCase(name, "STATUS")) {
+            cancelled = equalsIgnoreCase(value, "CANCELLED");
+            completed = completed || equalsIgnoreCase(value, "COMPLETED");
+        } else if (equalsIgnoreCase(name, "X-COMPLETED")) {
+            completed = equalsIgnoreCase(value, "TRUE");
+        } else if (equalsIgnoreCase(name, "RRULE")) {
+            parseRrule(value, local, rule);
+        }
+    }
+
+public:
+    explicit IcsImporter(EventSink& sink) : sink(sink), depth(0) {
+        beginEvent();
+    }
+
+    bool finish() { return true; }
+
+    size_t consume(const char* data, size_t size, bool final) {
+        size_t pos = 0;
+        while (pos < size) {
+            // A logical line runs until a line break not followed by a space or tab
+            size_t scan = pos;
+            size_t lineEnd, next;
+            bool folded = false;
+            while (true) {
+                const char* newline = static_cast<const char*>(std::memchr(data + scan, '\n', size - scan));
+                if (newline == nullptr) {
+                    if (!final) return pos;
+                    lineEnd = next = size;
+                    break;
+                }
+                size_t at = static_cast<size_t>(newline - data);
+                if (at + 1 >= size && !final) return pos; // The next line could be a continuation
+                if (at + 1 < size && (data[at + 1] == ' ' || data[at + 1] == '\t')) {
+                    folded = true;
+                    scan = at + 1;
+                    continue;
+                }
+                lineEnd = at;
+                next = at + 1;
+                break;
+            }
+
+            Text line(data + pos, lineEnd - pos);
+            if (folded) {
+                unfolded.clear();
+                for (size_t i = 0; i < line.size(); ++i) {
+                    if (line[i] == '\r') continue;
+                    if (line[i] == '\n') {
+                        ++i; // Also drop the space or tab that marks the continuation
+                        continue;
+                    }
+                    unfolded += line[i];
+                }
+                line = unfolded;
+            } else if (!line.empty() && line.back() == '\r') {
+                line.remove_suffix(1);
+            }
+            handleLine(line);
+            pos = next;
+        }
+        return pos;
+    }
+};
+
+enum CsvColumn {
+    COL_SUBJECT, COL_START, COL_START_DATE, COL_START_TIME, COL_END, COL_END_DATE, COL_END_TIME,
+    COL_DESCRIPTION, COL_PRIORITY, COL_COMPLETED, COL_REPEAT, COL_COUNT
+};
+
+// CSV records (RFC 4180 quoting, records may span lines) -> events
+class CsvImporter {
+private:
+    EventSink& sink;
+    LocalClock local;
+    bool haveHeader;
+    bool badHeader;
+    bool skippingLine; // Dropping the rest of an overlong record's first line
+    int columns[COL_COUNT];
+    std::vector<Text> fields;
+    std::deque<std::string> owned; // Unquoted copies of fields with doubled quotes
+
+    // Splits the record at pos; false if it may continue past the data
+    bool splitRecord(const char* data, size_t size, size_t& pos, bool final) {
+        fields.clear();
+        owned.clear();
+        size_t i = pos;
+        while (true) {
+            if (i < size && data[i] == '"') {
+                size_t start = ++i;
+                bool doubled = false;
+                while (true) {
+                    const char* quote = static_cast<const char*>(std::memchr(data + i, '"', size - i));
+                    if (quote == nullptr) {
+                        if (!final) return false;
+                        i = size; // Unterminated quote: take the rest
+                        break;
+                    }
+                    i = static_cast<size_t>(quote - data);
+                    if (i + 1 >= size && !final) return false;
+                    if (i + 1 < size && data[i + 1] == '"') {
+                        doubled = true;
+                        i += 2;
+                        continue;
+                    }
+                    break;
+                }
+                Text raw(data + start, i - start);
+                if (i < size) ++i; // Closing quote
+                if (doubled) {
+                    owned.emplace_back();
+                    for (size_t k = 0; k < raw.size(); ++k) {
+                        owned.back() += raw[k];
+                        if (raw[k] == '"') ++k;
+                    }
+                    raw = owned.back();
+                }
+                fields.push_back(raw);
+                while (i < size && data[i] != ',' && data[i] != '\n') ++i; // Stray bytes after the quote
+            } else {
+                size_t start = i;
+                while (i < size && data[i] != ',' && data[i] != '\n') ++i;
+                Text raw(data + start, i - start);
+                if (!raw.empty() && raw.back() == '\r' && (i >= size || data[i] == '\n')) raw.remove_suffix(1);
+                fields.push_back(raw);
+            }
+
+            if (i >= size) {
+                if (!final) return false;
+                pos = size;
+                return true;
+            }
+            if (data[i] == ',') {
+                ++i;
+                continue;
+            }
+            pos = i + 1;
+            return true;
+        }
+    }
+
+    Text field(CsvColumn column) const {
+        int index = columns[column];
+        return index >= 0 && static_cast<size_t>(index) < fields.size() ? fields[index] : Text();
+    }
+
+    void readHeader() {
+        static const struct { const char* name; CsvColumn column; } names[] = {
+            {"subject", COL_SUBJECT}, {"title", COL_SUBJECT}, {"start", COL_START},
+            {"start date", COL_START_DATE}, {"start time", COL_START_TIME}, {"end", COL_END},
+            {"end date", COL_END_DATE}, {"end time", COL_END_TIME}, {"description", COL_DESCRIPTION},
+            {"priority", COL_PRIORITY}, {"completed", COL_COMPLETED}, {"repeat", COL_REPEAT}};
+        for (size_t i = 0; i < fields.size(); ++i) {
+            Text name = trim(fields[i]);
+            if (i == 0 && name.substr(0, 3) == "\xEF\xBB\xBF") name.remove_prefix(3); // UTF-8 byte order mark
+            for (const auto& known : names) {
+                if (equalsIgnoreCase(name, known.name) && columns[known.column] < 0) {
+                    columns[known.column] = static_cast<int>(i);
+                }
+            }
+        }
+        haveHeader = true;
+        badHeader = columns[COL_SUBJECT] < 0 || (columns[COL_START] < 0 && columns[COL_START_DATE] < 0);
+    }
+
+    // "YYYY-MM-DD HH:MM" in one column, or separate date and time columns. A
+    // time without a date is on the same day as sameDayAs, if given.
+    bool readTime(CsvColumn combined, CsvColumn dateColumn, CsvColumn timeColumn, const std::time_t* sameDayAs,
+                  std::time_t& out) {
+        int year, month, day, hour, minute, second;
+        Text date = field(dateColumn);
+        Text clock = field(timeColumn);
+        if (columns[combined] >= 0 && !trim(field(combined)).empty()) {
+            Text both = trim(field(combined));
+            size_t space = both.find_first_of(" T");
+            date = both.substr(0, space);
+            clock = space == Text::npos ? Text() : both.substr(space + 1);
+        }
+        if (!trim(date).empty()) {
+            if (!parseCsvDate(date, year, month, day)) return false;
+        } else if (sameDayAs != nullptr && !trim(clock).empty()) {
+            std::tm sameDay = *std::localtime(sameDayAs);
+            year = sameDay.tm_year + 1900;
+            month = sameDay.tm_mon + 1;
+            day = sameDay.tm_mday;
+        } else {
+            return false;
+        }
+        if (!parseCsvClock(clock, hour, minute, second)) return false;
+        return local.toTime(year, month, day, hour, minute, second, out);
+    }
+
+    void readEvent() {
+        if (fields.size() == 1 && fields[0].empty()) return; // Blank line
+
+        std::time_t start, end;
+        if (!readTime(COL_START, COL_START_DATE, COL_START_TIME, nullptr, start)) {
+            sink.stats.skipped++;
+            return;
+        }
+        int priority = 2;
+        Text level = trim(field(COL_PRIORITY));
+        if (equalsIgnoreCase(level, "high") || level == "1") priority = 1;
+        else if (equalsIgnoreCase(level, "low") || level == "3") priority = 3;
+
+        Text title = field(COL_SUBJECT);
+        Event event(title.empty() ? "(No title)" : std::string(title), std::string(field(COL_DESCRIPTION)),
+                    start, priority);
+
+        if (readTime(COL_END, COL_END_DATE, COL_END_TIME, &start, end) && end > start) {
+            event.setDuration(end - start);
+        }
+
+        Text repeat = trim(field(COL_REPEAT));
+        RecurrenceRule rule;
+        if (!repeat.empty() && RecurrenceRule::parse(std::string(repeat), rule) && rule.isRecurring()) {
+            event.setRecurrence(rule);
+        }
+        Text completed = trim(field(COL_COMPLETED));
+        event.setCompleted(equalsIgnoreCase(completed, "true") || equalsIgnoreCase(completed, "yes") ||
+                           completed == "1");
+        sink.add(std::move(event));
+    }
+
+public:
+    explicit CsvImporter(EventSink& sink) : sink(sink), haveHeader(false), badHeader(false), skippingLine(false) {
+        for (int& column : columns) column = -1;
+    }
+
+    bool finish() {
+        if (!haveHeader || badHeader) {
+            std::cerr << "Error: CSV needs a header row with Subject and Start Date (or Start) columns." << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    size_t consume(const char* data, size_t size, bool final) {
+        size_t pos = 0;
+        while (pos < size && !badHeader) {
+            if (skippingLine) {
+                const char* newline = static_cast<const char*>(std::memchr(data + pos, '\n', size - pos));
+                if (newline == nullptr) return size;
+                pos = static_cast<size_t>(newline - data) + 1;
+                skippingLine = false;
+                continue;
+            }
+            size_t start = pos;
+            if (!splitRecord(data, size, pos, final)) {
+                if (size - start < MAX_CSV_RECORD) return start;
+                // Drop the record up to the end of its first line; the lines
+                // after it are read as records again
+                sink.stats.skipped++;
+                pos = start;
+                skippingLine = true;
+                continue;
+            }
+            if (!haveHeader) readHeader();
+            else readEvent();
+        }
+        return badHeader ? size : pos;
+    }
+};
+
+// Feeds the file to an importer chunk by chunk; what it leaves unconsumed is
+// carried into the next chunk
+template <typename Importer>
+bool importChunks(std::ifstream& file, Importer& importer, InterchangeStats& stats) {
+    std::string buffer;
+    while (true) {
+        size_t carried = buffer.size();
+        buffer.resize(carried + READ_CHUNK);
+        file.read(&buffer[carried], READ_CHUNK);
+        size_t got = static_cast<size_t>(file.gcount());
+        buffer.resize(carried + got);
+        stats.bytes += got;
+
+        bool final = got < READ_CHUNK;
+        size_t consumed = importer.consume(buffer.data(), buffer.size(), final);
+        buffer.erase(0, consumed);
+        if (final) break;
+    }
+    return importer.finish();
+}
+
+// ---- Export
+
+// Buffers output and hands it to the file in large writes
+class Output {
+private:
+    std::ofstream& file;
+    InterchangeStats& stats;
+
+public:
+    std::string text;
+
+    Output(std::ofstream& file, InterchangeStats& stats) : file(file), stats(stats) {
+        text.reserve(WRITE_CHUNK + 4096);
+    }
+
+    void maybeFlush() {
+        if (text.size() >= WRITE_CHUNK) flush();
+    }
+
+    void flush() {
+        file.write(text.data(), static_cast<std::streamsize>(text.size()));
+        stats.bytes += text.size();
+        text.clear();
+    }
+};
+
+// Appends an iCalendar content line, folded at 75 octets without splitting a
+// UTF-8 character
+void appendIcsLine(std::string& out, Text line) {
+    size_t limit = FOLD_WIDTH;
+    while (line.size() > limit) {
+        size_t cut = limit;
+        while (cut > 1 && (static_cast<unsigned char>(line[cut]) & 0xC0) == 0x80) --cut;
+        out.append(line.data(), cut);
+        out += "\r\n ";
+        line.remove_prefix(cut);
+        limit = FOLD_WIDTH - 1; // Continuation lines start with a space
+    }
+    out.append(line.data(), line.size());
+    out += "\r\n";
+}
+
+void appendIcsText(std::string& out, const char* name, const std::string& value, std::string& line) {
+    line = name;
+    line += ':';
+    for (char c : value) {
+        if (c == '\\' || c == ';' || c == ',') {
+            line += '\\';
+            line += c;
+        } else if (c == '\n') {
+            line += "\\n";
+        } else if (c != '\r') {
+            line += c;
+        }
+    }
+    appendIcsLine(out, line);
+}
+
+// The rule from the event's current occurrence on, so COUNT is what remains
+RecurrenceRule remainingRule(const Event& event) {
+    RecurrenceRule rule = event.getRecurrence();
+    if (rule.count > 0) {
+        long done = event.occurrences().getIndex();
+        rule.count = rule.count > done ? rule.count - done : 1;
+    }
+    return rule;
+}
+
+void appendRrule(std::string& out, const RecurrenceRule& rule) {
+    long interval = rule.every;
+    const char* frequency = "DAILY";
+    switch (rule.type) {
+        case RecurrenceType::Daily: frequency = "DAILY"; break;
+        case RecurrenceType::Weekly: frequency = "WEEKLY"; break;
+        case RecurrenceType::Monthly:
+            frequency = rule.every % 12 == 0 ? "YEARLY" : "MONTHLY";
+            if (rule.every % 12 == 0) interval = rule.every / 12;
+            break;
+        case RecurrenceType::Interval:
+            if (rule.every % 3600 == 0) frequency = "HOURLY", interval = rule.every / 3600;
+            else if (rule.every % 60 == 0) frequency = "MINUTELY", interval = rule.every / 60;
+            else frequency = "SECONDLY";
+            break;
+        case RecurrenceType::None: return;
+    }
+    out += "RRULE:FREQ=";
+    out += frequency;
+    if (interval != 1) out += ";INTERVAL=" + std::to_string(interval);
+    if (rule.count > 0) out += ";COUNT=" + std::to_string(rule.count);
+    if (rule.until > 0) {
+        out += ";UNTIL=";
+        appendUtc(out, rule.until);
+    }
+    out += "\r\n";
+}
+
+void exportIcs(const EventManager& manager, Output& out, InterchangeStats& stats) {
+    std::string stamp;
+    appendUtc(stamp, std::time(nullptr));
+    std::string line;
+    out.text += "BEGIN:VCALENDAR\r\nVERSION:2.0\r\nPRODID:-//Event Reminder System//EN\r\n";
+
+    EventCursor cursor;
+    while (!cursor.atEnd()) {
+        for (const Event* event : manager.nextPage(cursor, PAGE_SIZE)) {
+            std::string& text = out.text;
+            text += "BEGIN:VEVENT\r\nUID:";
+            text += std::to_string(event->getId());
+            text += "@event-reminder\r\nDTSTAMP:";
+            text += stamp;
+            text += "\r\nDTSTART:";
+            appendUtc(text, event->getEventTime());
+            text += "\r\n";
+            if (event->getDuration() > 0) {
+                text += "DTEND:";
+                appendUtc(text, event->getEndTime());
+                text += "\r\n";
+            }
+            appendIcsText(text, "SUMMARY", event->getTitle(), line);
+            if (!event->getDescription().empty()) appendIcsText(text, "DESCRIPTION", event->getDescription(), line);
+            text += event->getPriority() == 1 ? "PRIORITY:1\r\n" : (event->getPriority() == 3 ? "PRIORITY:9\r\n"
+                                                                                             : "PRIORITY:5\r\n");
+            if (event->isRecurring()) appendRrule(text, remainingRule(*event));
+            if (event->getIsCompleted()) text += "X-COMPLETED:TRUE\r\n";
+            text += "END:VEVENT\r\n";
+            stats.events++;
+            out.maybeFlush();
+        }
+    }
+    out.text += "END:VCALENDAR\r\n";
+}
+
+void appendCsvField(std::string& out, const std::string& value) {
+    if (value.find_first_of(",\"\r\n") == std::string::npos) {
+        out += value;
+        return;
+    }
+    out += '"';
+    for (char c : value) {
+        if (c == '"') out += '"';
+        out += c;
+    }
+    out += '"';
+}
+
+void appendLocal(std::string& out, std::time_t time) {
+    char text[32];
+    std::tm local = *std::localtime(&time);
+    // Seconds only when there are any, which is what other calendars write
+    std::strftime(text, sizeof(text), local.tm_sec ? "%Y-%m-%d,%H:%M:%S" : "%Y-%m-%d,%H:%M", &local);
+    out += text;
+}
+
+void exportCsv(const EventManager& manager, Output& out, InterchangeStats& stats) {
+    out.text += "Subject,Start Date,Start Time,End Date,End Time,Description,Priority,Completed,Repeat\r\n";
+    EventCursor cursor;
+    while (!cursor.atEnd()) {
+        for (const Event* event : manager.nextPage(cursor, PAGE_SIZE)) {
+            std::string& text = out.text;
+            appendCsvField(text, event->getTitle());
+            text += ',';
+            appendLocal(text, event->getEventTime());
+            text += ',';
+            if (event->getDuration() > 0) appendLocal(text, event->getEndTime());
+            else text += ',';
+            text += ',';
+            appendCsvField(text, event->getDescription());
+            text += ',';
+            text += event->getPriorityString();
+            text += event->getIsCompleted() ? ",True," : ",False,";
+            if (event->isRecurring()) text += remainingRule(*event).toString();
+            text += "\r\n";
+            stats.events++;
+            out.maybeFlush();
+        }
+    }
+}
+
+} // namespace
+
+namespace Interchange {
+
+bool formatFor(const std::string& path, InterchangeFormat& format) {
+    size_t dot = path.rfind('.');
+    Text extension = dot == std::string::npos ? Text() : Text(path).substr(dot + 1);
+    if (equalsIgnoreCase(extension, "ics") || equalsIgnoreCase(extension, "ical")) {
+        format = InterchangeFormat::ICalendar;
+        return true;
+    }
+    if (equalsIgnoreCase(extension, "csv")) {
+        format = InterchangeFormat::Csv;
+        return true;
+    }
+    return false;
+}
+
+bool importFile(const std::string& path, InterchangeFormat format, EventManager& manager,
+                InterchangeStats& stats) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open file for import: " << path << std::endl;
+        return false;
+    }
+
+    stats = InterchangeStats();
+    EventSink sink(manager, stats);
+    bool imported;
+    if (format == InterchangeFormat::ICalendar) {
+        IcsImporter importer(sink);
+        imported = importChunks(file, importer, stats);
+    } else {
+        CsvImporter importer(sink);
+        imported = importChunks(file, importer, stats);
+    }
+    sink.flush();
+    return imported;
+}
+
+bool exportFile(const std::string& path, InterchangeFormat format, const EventManager& manager,
+                InterchangeStats& stats) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open file for export: " << path << std::endl;
+        return false;
+    }
+
+    stats = InterchangeStats();
+    Output out(file, stats);
+    if (format == InterchangeFormat::ICalendar) exportIcs(manager, out, stats);
+    else exportCsv(manager, out, stats);
+    out.flush();
+
+    file.close();
+    if (!file) {
+        std::cerr << "Error: Failed to write export file: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+} // namespace Interchange
@@ -0,0 +1,178 @@
+#include "../include/IntervalTree.h"
+#include <algorithm>
+
+IntervalTree::IntervalTree() : root(nullptr), count(0), seed(2463534242u) {}
+
+IntervalTree::~IntervalTree() {
+    destroy(root);
+}
+
+uint32_t IntervalTree::nextWeight() {
+    // xorshift32: cheap, and balance only needs the weights to look random
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+bool IntervalTree::keyLess(std::time_t startA, int idA, std::time_t startB, int idB) {
+    return startA != startB ? startA < startB : idA < idB;
+}
+
+void IntervalTree::refresh(Node* node) {
+    node->maxEnd = node->end;
+    if (node->left != nullptr && node->left->maxEnd > node->maxEnd) node->maxEnd = node->left->maxEnd;
+    if (node->right != nullptr && node->right->maxEnd > node->maxEnd) node->maxEnd = node->right->maxEnd;
+}
+
+void IntervalTree::split(Node* node, std::time_t start, int id, Node*& left, Node*& right) {
+    if (node == nullptr) {
+        left = right = nullptr;
+        return;
+    }
+    if (keyLess(node->start, node->id, start, id)) {
+        split(node->right, start, id, node->right, right);
+        left = node;
+    } else {
+        split(node->left, start, id, left, node->left);
+        right = node;
+    }
+    refresh(node);
+}
+
+IntervalTree::Node* IntervalTree::merge(Node* left, Node* right) {
+    if (left == nullptr) return right;
+    if (right == nullptr) return left;
+    if (left->weight > right->weight) {
+        left->right = merge(left->right, right);
+        refresh(left);
+        return left;
+    }
+    right->left = merge(left, right->left);
+    refresh(right);
+    return right;
+}
+
+IntervalTree::Node* IntervalTree::unite(Node* a, Node* b) {
+    if (a == nullptr) return b;
+    if (b == nullptr) return a;
+    if (a->weight < b->weight) std::swap(a, b);
+    Node* left;
+    Node* right;
+    split(b, a->start, a->id, left, right);
+    a->left = unite(a->left, left);
+    a->right = unite(a->right, right);
+    refresh(a);
+    return a;
+}
+
+void IntervalTree::destroy(Node* node) {
+    while (node != nullptr) {
+        destroy(node->left);
+        Node* right = node->right;
+        delete node;
+        node = right;
+    }
+}
+
+std::time_t IntervalTree::slotEnd(const Event& event) {
+    std::time_t end = event.getEndTime();
+    return end > event.getEventTime() ? end : event.getEventTime() + 60;
+}
+
+IntervalTree::Node* IntervalTree::makeNode(EventNode* event) {
+    Node* node = new Node;
+    node->start = event->event.getEventTime();
+    node->end = slotEnd(event->event);
+    node->maxEnd = node->end;
+    node->id = event->event.getId();
+    node->weight = nextWeight();
+    node->event = event;
+    node->left = node->right = nullptr;
+    return node;
+}
+
+void IntervalTree::insert(EventNode* event) {
+    Node* node = makeNode(event);
+    Node* left;
+    Node* right;
+    split(root, node->start, node->id, left, right);
+    root = merge(merge(left, node), right);
+    count++;
+}
+
+void IntervalTree::insertAll(std::vector<EventNode*> events) {
+    std::sort(events.begin(), events.end(), [](const EventNode* a, const EventNode* b) {
+        return keyLess(a->event.getEventTime(), a->event.getId(), b->event.getEventTime(), b->event.getId());
+    });
+
+    // Cartesian tree build: the stack holds the right spine. A node pops every
+    // lighter node off it and adopts the last one as its left child; popped
+    // subtrees are final, so their maxEnd is settled as they leave.
+    std::vector<Node*> spine;
+    for (EventNode* event : events) {
+        Node* node = makeNode(event);
+        Node* last = nullptr;
+        while (!spine.empty() && spine.back()->weight < node->weight) {
+            last = spine.back();
+            spine.pop_back();
+            refresh(last);
+        }
+        node->left = last;
+        if (!spine.empty()) spine.back()->right = node;
+        spine.push_back(node);
+    }
+    for (auto it = spine.rbegin(); it != spine.rend(); ++it) {
+        refresh(*it);
+    }
+    Node* built = spine.empty() ? nullptr : spine.front();
+    root = unite(root, built);
+    count += events.size();
+}
+
+bool IntervalTree::erase(const EventNode* event) {
+    std::time_t start = event->event.getEventTime();
+    int id = event->event.getId();
+
+    // Walk down to the node, remembering the path so maxEnd can be fixed on the way back
+    std::vector<Node*> path;
+    Node** link = &root;
+    while (*link != nullptr && (*link)->event != event) {
+        path.push_back(*link);
+        link = keyLess(start, id, (*link)->start, (*link)->id) ? &(*link)->left : &(*link)->right;
+    }
+    if (*link == nullptr) return false;
+
+    Node* found = *link;
+    *link = merge(found->left, found->right);
+    delete found;
+    count--;
+
+    for (auto it = path.rbegin(); it != path.rend(); ++it) {
+        refresh(*it);
+    }
+    return true;
+}
+
+void IntervalTree::clear() {
+    destroy(root);
+    root = nullptr;
+    count = 0;
+}
+
+void IntervalTree::collect(const Node* node, std::time_t from, std::time_t to,
+                           std::vector<const EventNode*>& out) {
+    // Nothing in this subtree ends after from
+    if (node == nullptr || node->maxEnd <= from) return;
+
+    collect(node->left, from, to, out);
+    if (node->start >= to) return; // This node and everything to its right start too late
+    if (node->end > from) out.push_back(node->event);
+    collect(node->right, from, to, out);
+}
+
+std::vector<const EventNode*> IntervalTree::overlapping(std::time_t from, std::time_t to) const {
+    std::vector<const EventNode*> result;
+    collect(root, from, to, result);
+    return result;
+}
@@ -0,0 +1,226 @@
+#include "../include/LoadGenerator.h"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <random>
+#include <thread>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#ifdef __linux__
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+#ifdef __linux__
+
+namespace {
+
+typedef std::chrono::steady_clock LoadClock;
+
+struct WorkerResult {
+    std::vector<double> latenciesUs;
+    size_t errors = 0;
+    bool connected = false;
+};
+
+struct InFlight {
+    uint8_t opcode;
+    LoadClock::time_point sent;
+};
+
+int connectTo(const std::string& path) {
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool writeAll(int fd, const std::string& data) {
+    size_t offset = 0;
+    while (offset < data.size()) {
+        ssize_t written = ::write(fd, data.data() + offset, data.size() - offset);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        offset += written;
+    }
+    return true;
+}
+
+void runWorker(const LoadConfig& config, int worker, WorkerResult& result) {
+    int fd = connectTo(config.socketPath);
+    if (fd < 0) return;
+    result.connected = true;
+    result.latenciesUs.reserve(config.requestsPerConnection);
+
+    std::mt19937 rng(1234 + worker);
+    std::uniform_int_distribution<int> percent(0, 99);
+    std::deque<InFlight> inFlight;
+    std::deque<int32_t> ownedIds; // Events this worker added and may remove
+    std::string output;
+    std::string input;
+    uint32_t nextRequestId = 1;
+    size_t sent = 0;
+    size_t received = 0;
+    char buffer[64 * 1024];
+
+    while (received < config.requestsPerConnection) {
+        // Top up the pipeline
+        output.clear();
+        while (sent < config.requestsPerConnection && inFlight.size() < config.pipelineDepth) {
+            uint8_t opcode;
+            int roll = percent(rng);
+            if (roll < config.writePercent) {
+                opcode = (!ownedIds.empty() && roll % 2 == 1) ? Protocol::OP_REMOVE : Protocol::OP_ADD;
+            } else if (roll < 90 || ownedIds.empty()) {
+                opcode = ownedIds.empty() ? Protocol::OP_PING : Protocol::OP_FIND;
+            } else if (roll < 97) {
+                opcode = Protocol::OP_UPCOMING;
+            } else {
+                opcode = Protocol::OP_SEARCH;
+            }
+
+            Protocol::Writer writer(output, opcode, nextRequestId++);
+            switch (opcode) {
+                case Protocol::OP_ADD:
+                    writer.str("Load test " + std::to_string(worker));
+                    writer.str("Generated by --loadgen");
+                    writer.i64(static_cast<int64_t>(std::time(nullptr)) + 3600 + roll * 60);
+                    writer.u8(static_cast<uint8_t>(1 + roll % 3));
+                    break;
+                case Protocol::OP_REMOVE:
+                    writer.i32(ownedIds.front());
+                    ownedIds.pop_front();
+                    break;
+                case Protocol::OP_FIND:
+                    writer.i32(ownedIds[rng() % ownedIds.size()]);
+                    break;
+                case Protocol::OP_UPCOMING:
+                    writer.i32(1);
+                    break;
+                case Protocol::OP_SEARCH:
+                    writer.str("Load test " + std::to_string(worker));
+                    break;
+                default:
+                    break;
+            }
+            writer.finish();
+            inFlight.push_back(InFlight{opcode, LoadClock::now()});
+            sent++;
+        }
+        if (!output.empty() && !writeAll(fd, output)) break;
+
+        // Collect at least one response
+        ssize_t count = ::read(fd, buffer, sizeof(buffer));
+        if (count < 0 && errno == EINTR) continue;
+        if (count <= 0) break;
+        input.append(buffer, count);
+
+        size_t offset = 0;
+        while (true) {
+            size_t size = Protocol::frameSize(input.data() + offset, input.size() - offset);
+            if (size == 0 || size == SIZE_MAX || inFlight.empty()) break;
+
+            const char* frame = input.data() + offset;
+            InFlight request = inFlight.front();
+            inFlight.pop_front();
+            result.latenciesUs.push_back(std::chrono::duration<double, std::micro>(
+                LoadClock::now() - request.sent).count());
+
+            uint8_t status = static_cast<uint8_t>(frame[4]);
+            if (status != Protocol::STATUS_OK) {
+                result.errors++;
+            } else if (request.opcode == Protocol::OP_ADD) {
+                Protocol::Reader reader(frame + Protocol::HEADER_SIZE, size - Protocol::HEADER_SIZE);
+                ownedIds.push_back(reader.i32());
+            }
+            offset += size;
+            received++;
+        }
+        input.erase(0, offset);
+    }
+
+    // Leave the store as we found it
+    for (int32_t id : ownedIds) {
+        output.clear();
+        Protocol::Writer writer(output, Protocol::OP_REMOVE, nextRequestId++);
+        writer.i32(id);
+        writer.finish();
+        if (!writeAll(fd, output)) break;
+    }
+    ::shutdown(fd, SHUT_WR);
+    while (::read(fd, buffer, sizeof(buffer)) > 0) {}
+    ::close(fd);
+}
+
+} // namespace
+
+bool LoadGenerator::run() {
+    std::vector<WorkerResult> results(config.connections);
+    std::vector<std::thread> workers;
+
+    std::cout << "Load test: " << config.connections << " connection(s) x "
+              << config.requestsPerConnection << " request(s), pipeline depth "
+              << config.pipelineDepth << ", " << config.writePercent << "% writes" << std::endl;
+
+    auto start = LoadClock::now();
+    for (int i = 0; i < config.connections; ++i) {
+        workers.emplace_back(runWorker, std::cref(config), i, std::ref(results[i]));
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    double seconds = std::chrono::duration<double>(LoadClock::now() - start).count();
+
+    std::vector<double> latencies;
+    size_t errors = 0;
+    for (const WorkerResult& result : results) {
+        if (!result.connected) {
+            std::cerr << "Error: Could not connect to " << config.socketPath << std::endl;
+            return false;
+        }
+        latencies.insert(latencies.end(), result.latenciesUs.begin(), result.latenciesUs.end());
+        errors += result.errors;
+    }
+    if (latencies.empty()) {
+        std::cerr << "No responses received." << std::endl;
+        return false;
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&latencies](double p) {
+        return latencies[std::min(latencies.size() - 1, static_cast<size_t>(latencies.size() * p))];
+    };
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "Responses:   " << latencies.size() << " (" << errors << " error status)" << std::endl;
+    std::cout << "Elapsed:     " << seconds << " s" << std::endl;
+    std::cout << "Throughput:  " << latencies.size() / seconds << " requests/s" << std::endl;
+    std::cout << "Latency p50: " << percentile(0.50) << " us" << std::endl;
+    std::cout << "Latency p99: " << percentile(0.99) << " us" << std::endl;
+    std::cout << "Latency max: " << latencies.back() << " us" << std::endl;
+    return true;
+}
+
+#else
+
+bool LoadGenerator::run() {
+    std::cerr << "Load generator is only available on Linux." << std::endl;
+    return false;
+}
+
+#endif
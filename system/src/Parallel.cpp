@@ -0,0 +1,48 @@
+#include "../include/Parallel.h"
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <mutex>
+#include <exception>
+
+namespace Parallel {
+
+unsigned workerCount(size_t count) {
+    unsigned cores = std::thread::hardware_concurrency();
+    if (cores == 0) cores = 1;
+    return count < cores ? static_cast<unsigned>(count > 0 ? count : 1) : cores;
+}
+
+void forEach(size_t count, const std::function<void(size_t index)>& task) {
+    unsigned threads = workerCount(count);
+    if (threads <= 1) {
+        for (size_t i = 0; i < count; ++i) task(i);
+        return;
+    }
+
+    std::atomic<size_t> next(0);
+    std::exception_ptr failure;
+    std::mutex failureMutex;
+    auto work = [&]() {
+        try {
+            for (size_t i = next++; i < count; i = next++) task(i);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(failureMutex);
+            if (!failure) failure = std::current_exception();
+            next = count; // Stop handing out work
+        }
+    };
+
+    // The calling thread is one of the workers
+    std::vector<std::thread> pool;
+    for (unsigned i = 1; i < threads; ++i) {
+        pool.emplace_back(work);
+    }
+    work();
+    for (std::thread& thread : pool) {
+        thread.join();
+    }
+    if (failure) std::rethrow_exception(failure);
+}
+
+} // namespace Parallel
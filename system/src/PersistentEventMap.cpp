@@ -0,0 +1,240 @@
+#include "../include/PersistentEventMap.h"
+#include <algorithm>
+
+namespace {
+
+const unsigned BITS = 5;
+const uint32_t MASK = (1u << BITS) - 1;
+
+inline unsigned slotIndex(uint32_t bitmap, uint32_t bit) {
+    return static_cast<unsigned>(__builtin_popcount(bitmap & (bit - 1)));
+}
+
+} // namespace
+
+PersistentEventMap::NodePtr PersistentEventMap::join(const Value& a, const Value& b, unsigned shift) {
+    std::shared_ptr<Node> node = std::make_shared<Node>();
+    uint32_t indexA = (keyOf(a) >> shift) & MASK;
+    uint32_t indexB = (keyOf(b) >> shift) & MASK;
+
+    if (indexA == indexB) {
+        // Same branch at this level too: push both one level down
+        node->bitmap = 1u << indexA;
+        node->slots.push_back(Slot{join(a, b, shift + BITS), Value()});
+    } else {
+        node->bitmap = (1u << indexA) | (1u << indexB);
+        Slot first{NodePtr(), indexA < indexB ? a : b};
+        Slot second{NodePtr(), indexA < indexB ? b : a};
+        node->slots.push_back(first);
+        node->slots.push_back(second);
+    }
+    return node;
+}
+
+std::shared_ptr<PersistentEventMap::Node> PersistentEventMap::writable(const NodePtr& node, bool inPlace) {
+    // A node reachable only through this map can't be observed by any snapshot
+    if (inPlace && node.use_count() == 1) {
+        return std::const_pointer_cast<Node>(node);
+    }
+    return std::make_shared<Node>(*node);
+}
+
+PersistentEventMap::NodePtr PersistentEventMap::insert(const NodePtr& node, const Value& value,
+                                                       unsigned shift, bool inPlace, bool& added) {
+    uint32_t key = keyOf(value);
+    uint32_t bit = 1u << ((key >> shift) & MASK);
+
+    if (!node) {
+        std::shared_ptr<Node> fresh = std::make_shared<Node>();
+        fresh->bitmap = bit;
+        fresh->slots.push_back(Slot{NodePtr(), value});
+        added = true;
+        return fresh;
+    }
+
+    // Path copy: only this node is duplicated, its other children are shared
+    std::shared_ptr<Node> copy = writable(node, inPlace);
+    unsigned index = slotIndex(node->bitmap, bit);
+
+    if (!(node->bitmap & bit)) {
+        copy->bitmap |= bit;
+        copy->slots.insert(copy->slots.begin() + index, Slot{NodePtr(), value});
+        added = true;
+        return copy;
+    }
+
+    Slot& slot = copy->slots[index];
+    if (slot.child) {
+        slot.child = insert(slot.child, value, shift + BITS, inPlace, added);
+    } else if (keyOf(slot.value) == key) {
+        slot.value = value;
+    } else {
+        slot.child = join(slot.value, value, shift + BITS);
+        slot.value.reset();
+        added = true;
+    }
+    return copy;
+}
+
+PersistentEventMap::NodePtr PersistentEventMap::remove(const NodePtr& node, uint32_t key,
+                                                       unsigned shift, bool inPlace, bool& removed) {
+    uint32_t bit = 1u << ((key >> shift) & MASK);
+    if (!node || !(node->bitmap & bit)) return node;
+
+    unsigned index = slotIndex(node->bitmap, bit);
+    const Slot& slot = node->slots[index];
+    NodePtr child;
+    Value value;
+
+    // A child of a shared node is shared too, even if only that node points to it
+    inPlace = inPlace && node.use_count() == 1;
+
+    if (slot.child) {
+        child = remove(slot.child, key, shift + BITS, inPlace, removed);
+        if (!removed) return node;
+        // Pull a lone event back up so paths stay short
+        if (child && child->slots.size() == 1 && !child->slots[0].child) {
+            value = child->slots[0].value;
+            child.reset();
+        }
+    } else if (keyOf(slot.value) == key) {
+        removed = true;
+    } else {
+        return node;
+    }
+
+    std::shared_ptr<Node> copy = writable(node, inPlace);
+    if (child || value) {
+        copy->slots[index] = Slot{child, value};
+    } else {
+        copy->bitmap &= ~bit;
+        copy->slots.erase(copy->slots.begin() + index);
+        if (copy->slots.empty()) return NodePtr();
+    }
+    return copy;
+}
+
+PersistentEventMap::Value PersistentEventMap::find(int id) const {
+    uint32_t key = static_cast<uint32_t>(id);
+    const Node* node = root.get();
+    for (unsigned shift = 0; node != nullptr; shift += BITS) {
+        uint32_t bit = 1u << ((key >> shift) & MASK);
+        if (!(node->bitmap & bit)) return Value();
+        const Slot& slot = node->slots[slotIndex(node->bitmap, bit)];
+        if (!slot.child) return keyOf(slot.value) == key ? slot.value : Value();
+        node = slot.child.get();
+    }
+    return Value();
+}
+
+PersistentEventMap PersistentEventMap::set(const Value& event) const {
+    bool added = false;
+    NodePtr updated = insert(root, event, 0, false, added);
+    return PersistentEventMap(updated, count + (added ? 1 : 0));
+}
+
+void PersistentEventMap::assign(const Value& event) {
+    bool added = false;
+    root = insert(root, event, 0, true, added);
+    if (added) count++;
+}
+
+void PersistentEventMap::remove(int id) {
+    bool removed = false;
+    root = remove(root, static_cast<uint32_t>(id), 0, true, removed);
+    if (removed) count--;
+}
+
+PersistentEventMap PersistentEventMap::erase(int id) const {
+    bool removed = false;
+    NodePtr updated = remove(root, static_cast<uint32_t>(id), 0, false, removed);
+    if (!removed) return *this;
+    return PersistentEventMap(updated, count - 1);
+}
+
+void PersistentEventMap::collect(const Slot& slot, std::vector<Value>& out) {
+    if (!slot.child) {
+        out.push_back(slot.value);
+        return;
+    }
+    for (const Slot& inner : slot.child->slots) {
+        collect(inner, out);
+    }
+}
+
+void PersistentEventMap::forEach(const std::function<void(const Event&)>& visit) const {
+    if (!root) return;
+    std::vector<const Node*> stack(1, root.get());
+    while (!stack.empty()) {
+        const Node* node = stack.back();
+        stack.pop_back();
+        for (const Slot& slot : node->slots) {
+            if (slot.child) stack.push_back(slot.child.get());
+            else visit(*slot.value);
+        }
+    }
+}
+
+void PersistentEventMap::forEachInPart(size_t part, const std::function<void(const Event&)>& visit) const {
+    const Slot& top = root->slots[part];
+    if (!top.child) {
+        visit(*top.value);
+        return;
+    }
+    std::vector<const Node*> stack(1, top.child.get());
+    while (!stack.empty()) {
+        const Node* node = stack.back();
+        stack.pop_back();
+        for (const Slot& slot : node->slots) {
+            if (slot.child) stack.push_back(slot.child.get());
+            else visit(*slot.value);
+        }
+    }
+}
+
+void PersistentEventMap::diffSlots(const Slot* a, const Slot* b, unsigned shift, const DiffVisitor& visit) {
+    if (a && b && a->child && b->child) {
+        if (a->child != b->child) diffNodes(*a->child, *b->child, shift + BITS, visit);
+        return;
+    }
+    if (a && b && !a->child && !b->child && a->value == b->value) return;
+
+    // Mixed shapes (or a side missing): compare the few events underneath by ID
+    std::vector<Value> before, after;
+    if (a) collect(*a, before);
+    if (b) collect(*b, after);
+    auto byId = [](const Value& x, const Value& y) { return x->getId() < y->getId(); };
+    std::sort(before.begin(), before.end(), byId);
+    std::sort(after.begin(), after.end(), byId);
+
+    size_t i = 0, j = 0;
+    while (i < before.size() || j < after.size()) {
+        if (j == after.size() || (i < before.size() && before[i]->getId() < after[j]->getId())) {
+            visit(before[i++].get(), nullptr);
+        } else if (i == before.size() || after[j]->getId() < before[i]->getId()) {
+            visit(nullptr, after[j++].get());
+        } else {
+            if (before[i] != after[j]) visit(before[i].get(), after[j].get());
+            ++i;
+            ++j;
+        }
+    }
+}
+
+void PersistentEventMap::diffNodes(const Node& a, const Node& b, unsigned shift, const DiffVisitor& visit) {
+    uint32_t present = a.bitmap | b.bitmap;
+    while (present != 0) {
+        uint32_t bit = present & (~present + 1);
+        present &= present - 1;
+        const Slot* slotA = (a.bitmap & bit) ? &a.slots[slotIndex(a.bitmap, bit)] : nullptr;
+        const Slot* slotB = (b.bitmap & bit) ? &b.slots[slotIndex(b.bitmap, bit)] : nullptr;
+        diffSlots(slotA, slotB, shift, visit);
+    }
+}
+
+void PersistentEventMap::diff(const PersistentEventMap& from, const PersistentEventMap& to,
+                              const DiffVisitor& visit) {
+    if (from.root == to.root) return;
+    Node empty;
+    diffNodes(from.root ? *from.root : empty, to.root ? *to.root : empty, 0, visit);
+}
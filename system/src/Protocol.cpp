@@ -0,0 +1,116 @@
+#include "../include/Protocol.h"
+#include <cstring>
+#include <cstdint>
+
+namespace Protocol {
+
+Writer::Writer(std::string& out, uint8_t code, uint32_t requestId) : out(out), start(out.size()) {
+    u32(0); // Length placeholder
+    u8(code);
+    u32(requestId);
+}
+
+void Writer::u8(uint8_t value) {
+    out.push_back(static_cast<char>(value));
+}
+
+void Writer::i32(int32_t value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void Writer::u32(uint32_t value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void Writer::i64(int64_t value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void Writer::str(const std::string& value) {
+    u32(static_cast<uint32_t>(value.size()));
+    out += value;
+}
+
+void Writer::event(const Event& event) {
+    i32(event.getId());
+    i64(static_cast<int64_t>(event.getEventTime()));
+    u8(static_cast<uint8_t>(event.getPriority()));
+    u8(event.getIsCompleted() ? 1 : 0);
+    str(event.getTitle());
+    str(event.getDescription());
+}
+
+void Writer::finish() {
+    uint32_t length = static_cast<uint32_t>(out.size() - start - sizeof(uint32_t));
+    std::memcpy(&out[start], &length, sizeof(length));
+}
+
+bool Reader::take(void* value, size_t length) {
+    if (!valid || size - offset < length) {
+        valid = false;
+        std::memset(value, 0, length);
+        return false;
+    }
+    std::memcpy(value, data + offset, length);
+    offset += length;
+    return true;
+}
+
+uint8_t Reader::u8() {
+    uint8_t value;
+    take(&value, sizeof(value));
+    return value;
+}
+
+int32_t Reader::i32() {
+    int32_t value;
+    take(&value, sizeof(value));
+    return value;
+}
+
+uint32_t Reader::u32() {
+    uint32_t value;
+    take(&value, sizeof(value));
+    return value;
+}
+
+int64_t Reader::i64() {
+    int64_t value;
+    take(&value, sizeof(value));
+    return value;
+}
+
+std::string Reader::str() {
+    uint32_t length = u32();
+    if (!valid || size - offset < length) {
+        valid = false;
+        return std::string();
+    }
+    std::string value(data + offset, length);
+    offset += length;
+    return value;
+}
+
+EventRecord Reader::event() {
+    EventRecord record;
+    record.id = i32();
+    record.time = i64();
+    record.priority = u8();
+    record.completed = u8() != 0;
+    record.title = str();
+    record.description = str();
+    return record;
+}
+
+size_t frameSize(const char* data, size_t available) {
+    if (available < sizeof(uint32_t)) return 0;
+
+    uint32_t length;
+    std::memcpy(&length, data, sizeof(length));
+    if (length < HEADER_SIZE - sizeof(uint32_t) || length > MAX_BODY) return SIZE_MAX;
+
+    size_t total = sizeof(uint32_t) + length;
+    return available >= total ? total : 0;
+}
+
+} // namespace Protocol
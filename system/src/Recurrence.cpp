@@ -0,0 +1,170 @@
+#include "../include/Recurrence.h"
+#include <sstream>
+#include <vector>
+#include <cstdlib>
+
+namespace {
+
+const char* typeName(RecurrenceType type) {
+    switch (type) {
+        case RecurrenceType::Daily: return "daily";
+        case RecurrenceType::Weekly: return "weekly";
+        case RecurrenceType::Monthly: return "monthly";
+        case RecurrenceType::Interval: return "interval";
+        default: return "none";
+    }
+}
+
+int daysInMonth(int year, int month) {
+    static const int days[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    if (month == 1) {
+        int fullYear = year + 1900;
+        bool leap = (fullYear % 4 == 0 && fullYear % 100 != 0) || fullYear % 400 == 0;
+        return leap ? 29 : 28;
+    }
+    return days[month];
+}
+
+std::tm localTime(std::time_t time) {
+    std::tm* timeinfo = std::localtime(&time);
+    return timeinfo ? *timeinfo : std::tm();
+}
+
+// Rough length of one step, used only to estimate an index before correcting it
+double approximateStep(const RecurrenceRule& rule) {
+    switch (rule.type) {
+        case RecurrenceType::Daily: return 86400.0 * rule.every;
+        case RecurrenceType::Weekly: return 7 * 86400.0 * rule.every;
+        case RecurrenceType::Monthly: return 30.44 * 86400.0 * rule.every;
+        default: return static_cast<double>(rule.every);
+    }
+}
+
+} // namespace
+
+std::time_t RecurrenceRule::occurrence(std::time_t seriesStart, long k) const {
+    if (type == RecurrenceType::None || k == 0) return seriesStart;
+    if (type == RecurrenceType::Interval) return seriesStart + static_cast<std::time_t>(k) * every;
+
+    std::tm timeinfo = localTime(seriesStart);
+    if (type == RecurrenceType::Monthly) {
+        long months = static_cast<long>(timeinfo.tm_year) * 12 + timeinfo.tm_mon + k * every;
+        int year = static_cast<int>(months / 12);
+        int month = static_cast<int>(months % 12);
+        int day = timeinfo.tm_mday;
+        timeinfo.tm_year = year;
+        timeinfo.tm_mon = month;
+        timeinfo.tm_mday = day < daysInMonth(year, month) ? day : daysInMonth(year, month);
+    } else {
+        timeinfo.tm_mday += static_cast<int>(k * every * (type == RecurrenceType::Weekly ? 7 : 1));
+    }
+    timeinfo.tm_isdst = -1; // Keep the wall-clock time across DST changes
+    return std::mktime(&timeinfo);
+}
+
+bool RecurrenceRule::withinLimits(std::time_t time, long k) const {
+    if (k < 0) return false;
+    if (type == RecurrenceType::None) return k == 0;
+    if (count > 0 && k >= count) return false;
+    return until == 0 || time <= until;
+}
+
+std::string RecurrenceRule::describe() const {
+    if (!isRecurring()) return "Does not repeat";
+
+    std::ostringstream oss;
+    static const char* units[] = {"", "day", "week", "month"};
+    if (type == RecurrenceType::Interval) {
+        if (every % 3600 == 0) oss << "Every " << every / 3600 << " hour(s)";
+        else if (every % 60 == 0) oss << "Every " << every / 60 << " minute(s)";
+        else oss << "Every " << every << " second(s)";
+    } else if (every == 1) {
+        static const char* single[] = {"", "Daily", "Weekly", "Monthly"};
+        oss << single[static_cast<int>(type)];
+    } else {
+        oss << "Every " << every << " " << units[static_cast<int>(type)] << "s";
+    }
+
+    if (count > 0) oss << ", " << count << " times";
+    if (until != 0) {
+        char buffer[16];
+        std::tm timeinfo = localTime(until);
+        std::strftime(buffer, sizeof(buffer), "%Y-%m-%d", &timeinfo);
+        oss << ", until " << buffer;
+    }
+    return oss.str();
+}
+
+std::string RecurrenceRule::toString() const {
+    std::ostringstream oss;
+    oss << typeName(type) << ":" << every << ":" << count << ":" << until;
+    return oss.str();
+}
+
+bool RecurrenceRule::parse(const std::string& text, RecurrenceRule& rule) {
+    std::vector<std::string> parts;
+    std::istringstream iss(text);
+    std::string part;
+    while (std::getline(iss, part, ':')) parts.push_back(part);
+    if (parts.empty()) return false;
+
+    RecurrenceRule parsed;
+    const std::string& name = parts[0];
+    if (name == "none") parsed.type = RecurrenceType::None;
+    else if (name == "daily") parsed.type = RecurrenceType::Daily;
+    else if (name == "weekly") parsed.type = RecurrenceType::Weekly;
+    else if (name == "monthly") parsed.type = RecurrenceType::Monthly;
+    else if (name == "interval") parsed.type = RecurrenceType::Interval;
+    else return false;
+
+    char* end = nullptr;
+    if (parts.size() > 1) {
+        parsed.every = std::strtol(parts[1].c_str(), &end, 10);
+        if (*end != '\0' || parsed.every < 1) return false;
+    }
+    if (parts.size() > 2) {
+        parsed.count = std::strtol(parts[2].c_str(), &end, 10);
+        if (*end != '\0' || parsed.count < 0) return false;
+    }
+    if (parts.size() > 3) {
+        parsed.until = static_cast<std::time_t>(std::strtoll(parts[3].c_str(), &end, 10));
+        if (*end != '\0') return false;
+    }
+    if (parsed.type == RecurrenceType::Interval && parts.size() < 2) return false;
+
+    rule = parsed;
+    return true;
+}
+
+OccurrenceIterator::OccurrenceIterator(const RecurrenceRule& rule, std::time_t seriesStart, long index)
+    : rule(rule), seriesStart(seriesStart), index(index), current(0), valid(false) {
+    load();
+}
+
+void OccurrenceIterator::load() {
+    current = rule.occurrence(seriesStart, index);
+    valid = rule.withinLimits(current, index);
+}
+
+void OccurrenceIterator::next() {
+    if (!valid) return;
+    ++index;
+    load();
+}
+
+void OccurrenceIterator::seek(std::time_t time) {
+    if (!valid || current >= time) return;
+    if (!rule.isRecurring()) {
+        valid = false;
+        return;
+    }
+
+    // Estimate the index from the average step, then correct for calendar drift
+    long k = static_cast<long>((time - seriesStart) / approximateStep(rule));
+    if (k < index) k = index;
+    while (k > index && rule.occurrence(seriesStart, k - 1) >= time) --k;
+    while (rule.occurrence(seriesStart, k) < time) ++k;
+
+    index = k;
+    load();
+}
@@ -0,0 +1,320 @@
+#include "../include/Reports.h"
+#include "../include/Parallel.h"
+#include <algorithm>
+#include <utility>
+#include <climits>
+#include <fstream>
+#include <iostream>
+#include <cstdint>
+#include <cstdio>
+
+namespace {
+
+const std::time_t QUARTER_HOUR = 15 * 60;
+const long long DENSE_QUARTERS = 1 << 20; // About 30 years; wider spans are sorted instead
+const char COLUMNS_MAGIC[8] = {'E', 'V', 'C', 'O', 'L', '0', '0', '1'};
+
+// An event as the report counts it: its quarter hour, shifted left, and flags
+typedef long long Tally;
+const Tally COMPLETED = 1;
+const Tally OVERDUE = 2;
+const long long FLAG_SPAN = 4;
+
+struct Bucket {
+    int total = 0;
+    int completed = 0;
+    int overdue = 0;
+};
+
+// What one worker has seen. Tallies are appended in whatever order the events
+// come and counted afterwards, so the walk over the store only writes sequentially.
+struct Partial {
+    PriorityCount byPriority[3];
+    std::vector<Tally> tallies;
+    long long first = LLONG_MAX; // Quarter hours
+    long long last = LLONG_MIN;
+};
+
+void count(Bucket& bucket, Tally tally) {
+    bucket.total++;
+    if (tally & COMPLETED) bucket.completed++;
+    if (tally & OVERDUE) bucket.overdue++;
+}
+
+long long quarterOfTally(Tally tally) {
+    return (tally - (tally & (FLAG_SPAN - 1))) / FLAG_SPAN;
+}
+
+long long quarterOf(std::time_t time) {
+    long long quarter = time / QUARTER_HOUR;
+    return time % QUARTER_HOUR < 0 ? quarter - 1 : quarter;
+}
+
+// Local midnight of the day containing time, moved by days
+std::time_t localMidnight(std::time_t time, int days = 0) {
+    std::tm local = *std::localtime(&time);
+    local.tm_hour = local.tm_min = local.tm_sec = 0;
+    local.tm_mday += days;
+    local.tm_isdst = -1;
+    return std::mktime(&local);
+}
+
+std::time_t weekStart(std::time_t midnight) {
+    std::tm local = *std::localtime(&midnight);
+    return localMidnight(midnight, -((local.tm_wday + 6) % 7)); // Back to Monday
+}
+
+std::string formatDay(std::time_t day) {
+    char text[16];
+    std::strftime(text, sizeof(text), "%Y-%m-%d", std::localtime(&day));
+    return text;
+}
+
+void appendPercent(std::string& out, int part, int whole) {
+    char text[16];
+    std::snprintf(text, sizeof(text), "%5.1f%%", whole > 0 ? 100.0 * part / whole : 0.0);
+    out += text;
+}
+
+void appendPadded(std::string& out, const std::string& text, size_t width) {
+    if (text.size() < width) out.append(width - text.size(), ' ');
+    out += text;
+}
+
+// Splits the map's parts among the workers; task(group, part) for each part
+void forEachPart(const PersistentEventMap& events, size_t groups,
+                 const std::function<void(size_t group, size_t part)>& task) {
+    size_t parts = events.partCount();
+    Parallel::forEach(groups, [&](size_t group) {
+        for (size_t part = group; part < parts; part += groups) task(group, part);
+    });
+}
+
+template <typename T>
+void writeColumn(std::ofstream& file, const std::vector<T>& column) {
+    file.write(reinterpret_cast<const char*>(column.data()), column.size() * sizeof(T));
+}
+
+} // namespace
+
+namespace Reports {
+
+EventReport build(const PersistentEventMap& events, std::time_t now) {
+    EventReport report;
+    report.generatedAt = now;
+    report.events = events.size();
+
+    // One walk over the store on every core
+    size_t groups = Parallel::workerCount(events.partCount());
+    std::vector<Partial> partials(groups);
+    forEachPart(events, groups, [&](size_t group, size_t part) {
+        Partial& partial = partials[group];
+        if (partial.tallies.empty()) partial.tallies.reserve(events.size() / groups + 1);
+        events.forEachInPart(part, [&](const Event& event) {
+            int priority = event.getPriority();
+            bool completed = event.getIsCompleted();
+            if (priority >= 1 && priority <= 3) {
+                partial.byPriority[priority - 1].total++;
+                if (completed) partial.byPriority[priority - 1].completed++;
+            }
+            long long quarter = quarterOf(event.getEventTime());
+            if (quarter < partial.first) partial.first = quarter;
+            if (quarter > partial.last) partial.last = quarter;
+            Tally flags = completed ? COMPLETED : (event.getEventTime() <= now ? OVERDUE : 0);
+            partial.tallies.push_back(quarter * FLAG_SPAN + flags);
+        });
+    });
+
+    // Count per quarter hour: in a table spanning all of them when it is small
+    // enough to stay in cache, otherwise by sorting
+    long long first = LLONG_MAX, last = LLONG_MIN;
+    for (const Partial& partial : partials) {
+        for (int i = 0; i < 3; ++i) {
+            report.byPriority[i].total += partial.byPriority[i].total;
+            report.byPriority[i].completed += partial.byPriority[i].completed;
+        }
+        if (partial.first < first) first = partial.first;
+        if (partial.last > last) last = partial.last;
+    }
+    std::vector<std::pair<long long, Bucket>> quarters; // Occupied quarter hours, in order
+    if (report.events > 0 && last - first < DENSE_QUARTERS) {
+        std::vector<Bucket> dense(static_cast<size_t>(last - first + 1));
+        for (const Partial& partial : partials) {
+            for (Tally tally : partial.tallies) count(dense[quarterOfTally(tally) - first], tally);
+        }
+        for (size_t i = 0; i < dense.size(); ++i) {
+            if (dense[i].total > 0) quarters.emplace_back(first + static_cast<long long>(i), dense[i]);
+        }
+    } else {
+        std::vector<Tally> all;
+        all.reserve(report.events);
+        for (const Partial& partial : partials) {
+            all.insert(all.end(), partial.tallies.begin(), partial.tallies.end());
+        }
+        std::sort(all.begin(), all.end());
+        for (Tally tally : all) {
+            long long quarter = quarterOfTally(tally);
+            if (quarters.empty() || quarters.back().first != quarter) quarters.emplace_back(quarter, Bucket());
+            count(quarters.back().second, tally);
+        }
+    }
+
+    // Roll quarter hours up into local days and weeks, one date conversion per day
+    std::time_t dayEnd = 0;
+    std::time_t week = 0; // Of the current day, once needed
+    for (const auto& entry : quarters) {
+        std::time_t start = static_cast<std::time_t>(entry.first) * QUARTER_HOUR;
+        if (report.perDay.empty() || start >= dayEnd) {
+            std::time_t day = localMidnight(start);
+            dayEnd = localMidnight(day, 1);
+            week = 0;
+            report.perDay.push_back(DayCount{day, 0, 0});
+        }
+        DayCount& day = report.perDay.back();
+        day.total += entry.second.total;
+        day.completed += entry.second.completed;
+        if (entry.second.overdue > 0) {
+            if (week == 0) week = weekStart(day.day);
+            if (report.overdueByWeek.empty() || report.overdueByWeek.back().week != week) {
+                report.overdueByWeek.push_back(WeekCount{week, 0});
+            }
+            report.overdueByWeek.back().overdue += entry.second.overdue;
+        }
+    }
+    return report;
+}
+
+void render(const EventReport& report, std::string& out, size_t limit) {
+    out += "Events: " + std::to_string(report.events) + "\n\n";
+
+    static const char* const PRIORITY_NAMES[3] = {"High", "Medium", "Low"};
+    out += "Priority";
+    appendPadded(out, "Total", 11);
+    appendPadded(out, "Completed", 11);
+    out += "    Rate\n";
+    for (int i = 0; i < 3; ++i) {
+        const PriorityCount& count = report.byPriority[i];
+        std::string name = PRIORITY_NAMES[i];
+        out += name + std::string(8 - name.size(), ' ');
+        appendPadded(out, std::to_string(count.total), 11);
+        appendPadded(out, std::to_string(count.completed), 11);
+        out += "  ";
+        appendPercent(out, count.completed, count.total);
+        out += '\n';
+    }
+
+    out += "\nDay       ";
+    appendPadded(out, "Events", 10);
+    appendPadded(out, "Completed", 11);
+    out += '\n';
+    size_t shown = report.perDay.size() < limit ? report.perDay.size() : limit;
+    long long restEvents = 0;
+    for (size_t i = 0; i < report.perDay.size(); ++i) {
+        const DayCount& day = report.perDay[i];
+        if (i >= shown) {
+            restEvents += day.total;
+            continue;
+        }
+        out += formatDay(day.day);
+        appendPadded(out, std::to_string(day.total), 10);
+        appendPadded(out, std::to_string(day.completed), 11);
+        out += '\n';
+    }
+    if (shown < report.perDay.size()) {
+        out += "... " + std::to_string(report.perDay.size() - shown) + " more day(s), "
+             + std::to_string(restEvents) + " event(s)\n";
+    }
+
+    out += "\nWeek of   ";
+    appendPadded(out, "Overdue", 10);
+    out += '\n';
+    shown = report.overdueByWeek.size() < limit ? report.overdueByWeek.size() : limit;
+    restEvents = 0;
+    for (size_t i = 0; i < report.overdueByWeek.size(); ++i) {
+        const WeekCount& week = report.overdueByWeek[i];
+        if (i >= shown) {
+            restEvents += week.overdue;
+            continue;
+        }
+        out += formatDay(week.week);
+        appendPadded(out, std::to_string(week.overdue), 10);
+        out += '\n';
+    }
+    if (shown < report.overdueByWeek.size()) {
+        out += "... " + std::to_string(report.overdueByWeek.size() - shown) + " more week(s), "
+             + std::to_string(restEvents) + " event(s)\n";
+    }
+    if (report.overdueByWeek.empty()) {
+        out += "Nothing overdue.\n";
+    }
+}
+
+bool exportColumns(const std::string& path, const PersistentEventMap& events, size_t& bytes) {
+    // Gather each part's events, then give every part its range of rows
+    size_t parts = events.partCount();
+    std::vector<std::vector<const Event*>> members(parts);
+    size_t groups = Parallel::workerCount(parts);
+    forEachPart(events, groups, [&](size_t, size_t part) {
+        members[part].reserve(events.size() / parts + 1);
+        events.forEachInPart(part, [&](const Event& event) { members[part].push_back(&event); });
+    });
+    std::vector<size_t> firstRow(parts + 1, 0);
+    for (size_t part = 0; part < parts; ++part) {
+        firstRow[part + 1] = firstRow[part] + members[part].size();
+    }
+
+    size_t rows = firstRow[parts];
+    std::vector<int32_t> ids(rows);
+    std::vector<int64_t> times(rows), durations(rows);
+    std::vector<uint8_t> priorities(rows), completed(rows);
+    std::vector<uint64_t> titleOffsets(rows + 1, 0);
+    forEachPart(events, groups, [&](size_t, size_t part) {
+        size_t row = firstRow[part];
+        for (const Event* event : members[part]) {
+            ids[row] = event->getId();
+            times[row] = event->getEventTime();
+            durations[row] = event->getDuration();
+            priorities[row] = static_cast<uint8_t>(event->getPriority());
+            completed[row] = event->getIsCompleted() ? 1 : 0;
+            titleOffsets[row + 1] = event->getTitle().size(); // Lengths until the prefix sum below
+            ++row;
+        }
+    });
+    for (size_t row = 0; row < rows; ++row) {
+        titleOffsets[row + 1] += titleOffsets[row];
+    }
+    std::string titles(titleOffsets[rows], '\0');
+    forEachPart(events, groups, [&](size_t, size_t part) {
+        size_t row = firstRow[part];
+        for (const Event* event : members[part]) {
+            std::string title = event->getTitle();
+            title.copy(&titles[titleOffsets[row]], title.size());
+            ++row;
+        }
+    });
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        std::cerr << "Error: Could not open file for export: " << path << std::endl;
+        return false;
+    }
+    uint64_t header[2] = {rows, titles.size()};
+    file.write(COLUMNS_MAGIC, sizeof(COLUMNS_MAGIC));
+    file.write(reinterpret_cast<const char*>(header), sizeof(header));
+    writeColumn(file, ids);
+    writeColumn(file, times);
+    writeColumn(file, durations);
+    writeColumn(file, priorities);
+    writeColumn(file, completed);
+    writeColumn(file, titleOffsets);
+    file.write(titles.data(), titles.size());
+    file.close();
+    if (!file) {
+        std::cerr << "Error: Failed to write export file: " << path << std::endl;
+        return false;
+    }
+    bytes = sizeof(COLUMNS_MAGIC) + sizeof(header) + rows * (4 + 8 + 8 + 1 + 1 + 8) + 8 + titles.size();
+    return true;
+}
+
+} // namespace Reports
@@ -0,0 +1,116 @@
+#include "../include/Scheduler.h"
+#include <queue>
+#include <utility>
+
+Scheduler::Scheduler(std::time_t agingHorizon) : agingHorizon(agingHorizon) {}
+
+std::time_t Scheduler::effectiveDeadline(const Event& event) const {
+    return event.getEventTime() + static_cast<std::time_t>(event.getPriority() - 1) * agingHorizon;
+}
+
+std::time_t Scheduler::keyOf(const EventNode* node) const {
+    return effectiveDeadline(node->event);
+}
+
+bool Scheduler::before(const EventNode* a, const EventNode* b) const {
+    std::time_t keyA = keyOf(a);
+    std::time_t keyB = keyOf(b);
+    if (keyA != keyB) return keyA < keyB;
+    if (a->event.getPriority() != b->event.getPriority()) {
+        return a->event.getPriority() < b->event.getPriority();
+    }
+    return a->event.getId() < b->event.getId();
+}
+
+void Scheduler::place(size_t slot, EventNode* node) {
+    heap[slot] = node;
+    node->heapSlot = slot;
+}
+
+void Scheduler::siftUp(size_t slot) {
+    EventNode* node = heap[slot];
+    while (slot > 0) {
+        size_t parent = (slot - 1) / 2;
+        if (!before(node, heap[parent])) break;
+        place(slot, heap[parent]);
+        slot = parent;
+    }
+    place(slot, node);
+}
+
+void Scheduler::siftDown(size_t slot) {
+    EventNode* node = heap[slot];
+    size_t count = heap.size();
+    while (true) {
+        size_t child = 2 * slot + 1;
+        if (child >= count) break;
+        if (child + 1 < count && before(heap[child + 1], heap[child])) child++;
+        if (!before(heap[child], node)) break;
+        place(slot, heap[child]);
+        slot = child;
+    }
+    place(slot, node);
+}
+
+void Scheduler::push(EventNode* node) {
+    heap.push_back(node);
+    node->heapSlot = heap.size() - 1;
+    siftUp(node->heapSlot);
+}
+
+void Scheduler::erase(EventNode* node) {
+    size_t slot = node->heapSlot;
+    if (slot == EventNode::NOT_SCHEDULED) return;
+    node->heapSlot = EventNode::NOT_SCHEDULED;
+
+    EventNode* last = heap.back();
+    heap.pop_back();
+    if (last == node) return;
+
+    // Move the last node into the hole and restore order in whichever direction it needs
+    place(slot, last);
+    siftUp(slot);
+    siftDown(last->heapSlot);
+}
+
+void Scheduler::update(EventNode* node) {
+    if (node->heapSlot == EventNode::NOT_SCHEDULED) return;
+    siftUp(node->heapSlot);
+    siftDown(node->heapSlot);
+}
+
+void Scheduler::clear() {
+    for (EventNode* node : heap) {
+        node->heapSlot = EventNode::NOT_SCHEDULED;
+    }
+    heap.clear();
+}
+
+void Scheduler::setAgingHorizon(std::time_t horizon) {
+    agingHorizon = horizon;
+    for (size_t slot = heap.size() / 2; slot-- > 0;) {
+        siftDown(slot);
+    }
+}
+
+std::vector<const EventNode*> Scheduler::top(size_t k) const {
+    std::vector<const EventNode*> result;
+    if (heap.empty() || k == 0) return result;
+    result.reserve(k);
+
+    // Frontier of heap slots whose parents were already taken
+    auto later = [this](size_t a, size_t b) { return before(heap[b], heap[a]); };
+    std::priority_queue<size_t, std::vector<size_t>, decltype(later)> frontier(later);
+    frontier.push(0);
+
+    while (!frontier.empty() && result.size() < k) {
+        size_t slot = frontier.top();
+        frontier.pop();
+        result.push_back(heap[slot]);
+
+        size_t child = 2 * slot + 1;
+        if (child < heap.size()) frontier.push(child);
+        if (child + 1 < heap.size()) frontier.push(child + 1);
+    }
+    return result;
+}
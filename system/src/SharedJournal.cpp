@@ -0,0 +1,366 @@
+#include "../include/SharedJournal.h"
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+
+namespace {
+
+const char MAGIC[8] = {'E', 'V', 'J', 'R', 'N', 'L', '0', '1'};
+const uint64_t HEADER_SIZE = 64;
+const uint64_t ENTRY_HEADER = 9;
+const uint64_t INITIAL_SIZE = 1 << 20;
+const uint64_t COMPACT_BYTES = 16 << 20; // Journal size that triggers a compaction
+// Address space set aside for the mapping; the file grows inside it
+const uint64_t RESERVED = sizeof(void*) >= 8 ? (uint64_t(1) << 30) : (uint64_t(128) << 20);
+const uint8_t OP_PUT = 1;
+const uint8_t OP_REMOVE = 2;
+
+struct Header {
+    char magic[8];
+    uint64_t generation; // Bumped by every compaction
+    uint64_t end;        // Entries run from HEADER_SIZE up to here
+    uint64_t capacity;   // File size
+};
+
+Header& headerOf(char* map) {
+    return *reinterpret_cast<Header*>(map);
+}
+
+// Holds an flock on the journal for one scope
+class FileLock {
+private:
+    int fd;
+
+public:
+    FileLock(int fd, int operation) : fd(fd) {
+        while (::flock(fd, operation) != 0 && errno == EINTR) {
+        }
+    }
+    ~FileLock() { ::flock(fd, LOCK_UN); }
+};
+
+} // namespace
+
+SharedJournal::SharedJournal(FileHandler& file, EventManager& events)
+    : file(file), events(events), path(file.getFilename() + ".shared"), fd(-1), map(nullptr), generation(0),
+      readOffset(HEADER_SIZE), applying(false) {
+    observer = events.getChangeFeed().subscribe([this](const ChangeRecord& change) { record(change); });
+}
+
+SharedJournal::~SharedJournal() {
+    events.getChangeFeed().unsubscribe(observer);
+    if (map) ::munmap(map, RESERVED);
+    if (fd >= 0) ::close(fd);
+}
+
+bool SharedJournal::open() {
+    int opened = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (opened < 0) {
+        std::cerr << "Error: Could not open shared journal " << path << std::endl;
+        return false;
+    }
+    {
+        // Whoever creates the file writes the header before anyone can read it
+        FileLock lock(opened, LOCK_EX);
+        struct stat info;
+        uint64_t size = ::fstat(opened, &info) == 0 ? static_cast<uint64_t>(info.st_size) : 0;
+        bool fresh = size == 0;
+        if (fresh && ::ftruncate(opened, INITIAL_SIZE) == 0) size = INITIAL_SIZE;
+        void* mapped = size >= HEADER_SIZE
+                           ? ::mmap(nullptr, RESERVED, PROT_READ | PROT_WRITE, MAP_SHARED, opened, 0)
+                           : MAP_FAILED;
+        if (mapped != MAP_FAILED) {
+            Header& header = headerOf(static_cast<char*>(mapped));
+            if (fresh) {
+                std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+                header.generation = 1;
+                header.end = HEADER_SIZE;
+                header.capacity = INITIAL_SIZE;
+            }
+            if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 && header.end >= HEADER_SIZE &&
+                header.end <= header.capacity && header.capacity <= size && header.capacity <= RESERVED) {
+                map = static_cast<char*>(mapped);
+                generation = header.generation;
+            } else {
+                ::munmap(mapped, RESERVED);
+            }
+        }
+    }
+    if (!map) {
+        std::cerr << "Error: " << path << " is not a usable shared journal" << std::endl;
+        ::close(opened);
+        return false;
+    }
+    fd = opened;
+    return true;
+}
+
+bool SharedJournal::load(const std::function<bool()>& readFile) {
+    this->readFile = readFile;
+    if (fd < 0) return readFile();
+    FileLock lock(fd, LOCK_EX);
+    appendPending();
+    return reload();
+}
+
+size_t SharedJournal::sync() {
+    if (fd < 0) return 0;
+    size_t applied;
+    bool compactDue;
+    {
+        FileLock lock(fd, pending.empty() ? LOCK_SH : LOCK_EX);
+        applied = catchUp();
+        appendPending();
+        compactDue = headerOf(map).end > COMPACT_BYTES;
+    }
+    if (compactDue) compact();
+    return applied;
+}
+
+bool SharedJournal::compact() {
+    if (fd < 0) return file.saveEvents(events);
+    FileLock lock(fd, LOCK_EX);
+    catchUp();
+    if (!file.saveEvents(events)) {
+        appendPending(); // Kept in the journal instead
+        return false;
+    }
+    // Everything is in the data file now, our pending changes included
+    Header& header = headerOf(map);
+    header.end = HEADER_SIZE;
+    ++header.generation;
+    if (header.capacity > INITIAL_SIZE && ::ftruncate(fd, INITIAL_SIZE) == 0) header.capacity = INITIAL_SIZE;
+    generation = header.generation;
+    readOffset = HEADER_SIZE;
+    pending.clear();
+    pendingIds.clear();
+    addedIds.clear();
+    if (file.getSyncWrites()) syncRange(0, HEADER_SIZE);
+    return true;
+}
+
+void SharedJournal::reset() {
+    if (fd < 0) return;
+    FileLock lock(fd, LOCK_EX);
+    Header& header = headerOf(map);
+    header.end = HEADER_SIZE;
+    ++header.generation;
+    generation = header.generation;
+    readOffset = HEADER_SIZE;
+    pending.clear();
+    pendingIds.clear();
+    addedIds.clear();
+    if (file.getSyncWrites()) syncRange(0, HEADER_SIZE);
+}
+
+void SharedJournal::record(const ChangeRecord& change) {
+    if (applying || fd < 0) return;
+    switch (change.type) {
+        case ChangeType::Added:
+            queue(false, change.eventId, change.event, true);
+            break;
+        case ChangeType::Updated:
+            if (change.event.getId() != change.eventId) {
+                queue(true, change.eventId, change.event, false);
+                queue(false, change.event.getId(), change.event, true);
+            } else {
+                queue(false, change.eventId, change.event, false);
+            }
+            break;
+        case ChangeType::Completed:
+            queue(false, change.eventId, change.event, false);
+            break;
+        case ChangeType::Removed:
+            queue(true, change.eventId, change.event, false);
+            break;
+        case ChangeType::Cleared:
+            break; // Only ever ahead of a reload, which goes through load()
+    }
+}
+
+void SharedJournal::queue(bool remove, int id, const Event& event, bool added) {
+    pending.push_back(Entry{remove, id, event});
+    pendingIds.insert(id);
+    if (added) addedIds.insert(id);
+}
+
+size_t SharedJournal::catchUp() {
+    if (headerOf(map).generation != generation) {
+        reload();
+        return 1;
+    }
+    size_t applied = 0;
+    uint64_t end = headerOf(map).end;
+    applying = true;
+    while (readOffset + ENTRY_HEADER <= end) {
+        const char* entry = map + readOffset;
+        uint32_t size;
+        int32_t id;
+        std::memcpy(&size, entry, sizeof(size));
+        std::memcpy(&id, entry + 4, sizeof(id));
+        uint8_t op = static_cast<uint8_t>(entry[8]);
+        if (readOffset + ENTRY_HEADER + size > end || (op != OP_PUT && op != OP_REMOVE)) {
+            std::cerr << "Error: Damaged entry in " << path << " at byte " << readOffset
+                      << "; skipped the rest" << std::endl;
+            readOffset = end;
+            break;
+        }
+        try {
+            apply(op == OP_REMOVE, id, entry + ENTRY_HEADER, size);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: Unreadable event in " << path << " at byte " << readOffset << ": " << e.what()
+                      << std::endl;
+        }
+        readOffset += ENTRY_HEADER + size;
+        ++applied;
+    }
+    applying = false;
+    return applied;
+}
+
+bool SharedJournal::reload() {
+    applying = true;
+    events.clear();
+    bool loaded = readFile();
+    // Events created here and saved elsewhere under the same ID keep theirs;
+    // ours move, and the same happens for clashes within the journal
+    std::vector<int> clashes;
+    for (int id : addedIds) {
+        if (events.findEvent(id) != NO_EVENT) clashes.push_back(id);
+    }
+    for (int id : clashes) {
+        renumber(id);
+    }
+    generation = headerOf(map).generation;
+    readOffset = HEADER_SIZE;
+    catchUp();
+
+    // Our own changes go on top again
+    applying = true;
+    for (const Entry& entry : pending) {
+        EventHandle handle = events.findEvent(entry.id);
+        if (entry.remove) {
+            events.removeEvent(handle);
+        } else if (!events.updateEvent(handle, entry.event)) {
+            events.addEvent(entry.event);
+        }
+    }
+    applying = false;
+    return loaded;
+}
+
+void SharedJournal::apply(bool remove, int id, const char* payload, size_t size) {
+    if (addedIds.count(id)) {
+        // Another process created an event under the same ID before it saw
+        // ours; theirs keeps the ID and ours moves to a fresh one
+        EventHandle ours = events.findEvent(id);
+        int fresh = renumber(id);
+        const Event* event = events.getEvent(ours);
+        if (event != nullptr) events.updateEvent(ours, event->withId(fresh));
+    } else if (pendingIds.count(id)) {
+        return; // Ours is newer and goes in after it
+    }
+    if (remove) {
+        events.removeEvent(id);
+        return;
+    }
+    Event event = Event::deserialize(std::string(payload, size));
+    if (!events.updateEvent(events.findEvent(id), event)) events.addEvent(event);
+}
+
+int SharedJournal::renumber(int id) {
+    int fresh = Event::claimId();
+    for (Entry& entry : pending) {
+        if (entry.id != id) continue;
+        entry.id = fresh;
+        if (!entry.remove) entry.event = entry.event.withId(fresh);
+    }
+    pendingIds.erase(id);
+    pendingIds.insert(fresh);
+    addedIds.erase(id);
+    addedIds.insert(fresh);
+    std::cout << "Event " << id << " is now event " << fresh << " (another instance took the same ID)." << std::endl;
+    return fresh;
+}
+
+bool SharedJournal::appendPending() {
+    if (pending.empty()) return true;
+    Header& header = headerOf(map);
+    uint64_t start = header.end;
+    uint64_t offset = start;
+    for (const Entry& entry : pending) {
+        std::string payload = entry.remove ? std::string() : entry.event.serialize();
+        uint64_t next = offset + ENTRY_HEADER + payload.size();
+        if (next > header.capacity && !grow(next)) return false; // Nothing published; kept for later
+        uint32_t size = static_cast<uint32_t>(payload.size());
+        int32_t id = entry.id;
+        std::memcpy(map + offset, &size, sizeof(size));
+        std::memcpy(map + offset + 4, &id, sizeof(id));
+        map[offset + 8] = static_cast<char>(entry.remove ? OP_REMOVE : OP_PUT);
+        std::memcpy(map + offset + ENTRY_HEADER, payload.data(), payload.size());
+        offset = next;
+    }
+    // Entries first, then the end offset that makes them visible
+    if (file.getSyncWrites()) syncRange(start, offset);
+    header.end = offset;
+    if (file.getSyncWrites()) syncRange(0, HEADER_SIZE);
+    readOffset = offset;
+    pending.clear();
+    pendingIds.clear();
+    addedIds.clear();
+    return true;
+}
+
+bool SharedJournal::grow(uint64_t needed) {
+    Header& header = headerOf(map);
+    uint64_t capacity = std::max(needed, header.capacity * 2);
+    capacity = (capacity + INITIAL_SIZE - 1) / INITIAL_SIZE * INITIAL_SIZE;
+    if (capacity > RESERVED) capacity = RESERVED;
+    if (needed > capacity || ::ftruncate(fd, static_cast<off_t>(capacity)) != 0) {
+        std::cerr << "Error: Shared journal " << path << " is full; changes stay local until saved" << std::endl;
+        return false;
+    }
+    header.capacity = capacity;
+    return true;
+}
+
+void SharedJournal::syncRange(uint64_t from, uint64_t to) {
+    uint64_t page = static_cast<uint64_t>(::sysconf(_SC_PAGESIZE));
+    uint64_t start = from / page * page;
+    ::msync(map + start, static_cast<size_t>(to - start), MS_SYNC);
+}
+
+#else
+
+SharedJournal::SharedJournal(FileHandler& file, EventManager& events)
+    : file(file), events(events), path(file.getFilename() + ".shared"), fd(-1), map(nullptr), generation(0),
+      readOffset(0), applying(false), observer(0) {}
+
+SharedJournal::~SharedJournal() {}
+
+bool SharedJournal::open() {
+    std::cerr << "Shared mode is only available on Linux." << std::endl;
+    return false;
+}
+
+bool SharedJournal::load(const std::function<bool()>& readFile) {
+    this->readFile = readFile;
+    return readFile();
+}
+
+size_t SharedJournal::sync() { return 0; }
+bool SharedJournal::compact() { return file.saveEvents(events); }
+void SharedJournal::reset() {}
+
+#endif
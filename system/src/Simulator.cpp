@@ -0,0 +1,166 @@
+#include "../include/Simulator.h"
+#include "../include/FileHandler.h"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <random>
+#include <vector>
+
+namespace {
+// Fixed epoch so synthetic runs are reproducible
+const std::time_t SIMULATION_EPOCH = 1700000000;
+
+// Runs one manager query and adds its wall time to timing
+template <typename Query>
+auto timed(QueryTiming& timing, Query query) -> decltype(query()) {
+    auto started = std::chrono::steady_clock::now();
+    auto result = query();
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+    timing.calls++;
+    timing.totalMs += ms;
+    timing.maxMs = std::max(timing.maxMs, ms);
+    return result;
+}
+
+}
+
+Simulator::Simulator(const SimulationConfig& config)
+    : config(config), clock(SIMULATION_EPOCH), manager(clock) {}
+
+void Simulator::generateEvents(std::time_t start) {
+    std::mt19937 rng(config.seed);
+    std::uniform_int_distribution<std::time_t> offset(0, config.span);
+    std::uniform_int_distribution<int> priority(1, 3);
+
+    std::vector<Event> events;
+    events.reserve(config.eventCount);
+    for (size_t i = 0; i < config.eventCount; ++i) {
+        events.emplace_back("Simulated event " + std::to_string(i), "",
+                            start + offset(rng), priority(rng));
+    }
+    manager.addEvents(events);
+}
+
+bool Simulator::loadEvents() {
+    if (config.dataFile.empty()) {
+        generateEvents(SIMULATION_EPOCH);
+        return true;
+    }
+
+    FileHandler fileHandler(config.dataFile);
+    if (!fileHandler.fileExists()) {
+        std::cerr << "Error: Simulation data file not found: " << config.dataFile << std::endl;
+        return false;
+    }
+    return fileHandler.loadEvents(manager);
+}
+
+bool Simulator::run(SimulationReport& report) {
+    report = SimulationReport();
+    if (!loadEvents()) return false;
+    report.eventsLoaded = manager.getEventCount();
+
+    // The run covers the stored times of the pending events
+    std::time_t first = 0, last = 0;
+    bool any = false;
+    for (const Event& event : manager.getAllEvents()) {
+        if (event.getIsCompleted()) continue;
+        first = any ? std::min(first, event.getEventTime()) : event.getEventTime();
+        last = any ? std::max(last, event.getEventTime()) : event.getEventTime();
+        any = true;
+    }
+    if (!any) {
+        std::cout << "No pending events to simulate." << std::endl;
+        return true;
+    }
+
+    // Start one tick before the first reminder so every event fires in-run
+    std::time_t tick = std::max<std::time_t>(config.tick, 1);
+    std::time_t start = first - tick;
+    clock.set(start);
+
+    std::vector<double> lateness;
+    lateness.reserve(report.eventsLoaded);
+    auto wallStart = std::chrono::steady_clock::now();
+
+    while (clock.now() < last) {
+        clock.advance(tick);
+        std::time_t now = clock.now();
+
+        if (config.speed > 0.0) {
+            // Pace virtual time against the wall clock
+            auto target = wallStart + std::chrono::duration<double>((now - start) / config.speed);
+            std::this_thread::sleep_until(target);
+        }
+
+        int due = timed(report.dueCount, [this]() { return manager.getDueCount(); });
+        timed(report.upcomingReminders, [this]() { return manager.getUpcomingReminders(config.upcomingHours); });
+        if (due == 0) continue;
+
+        std::vector<Event> fired = timed(report.dueReminders, [this]() { return manager.getDueReminders(); });
+        for (const Event& event : fired) {
+            lateness.push_back(static_cast<double>(now - event.getEventTime()));
+            if (config.speed > 0.0) {
+                auto dueAt = wallStart + std::chrono::duration<double>((event.getEventTime() - start) / config.speed);
+                double lagMs = std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - dueAt).count();
+                report.maxWallLagMs = std::max(report.maxWallLagMs, lagMs);
+            }
+            // Acknowledged; a recurring event moves on to its next occurrence
+            manager.markEventCompleted(manager.findEvent(event.getId()));
+        }
+    }
+
+    report.wallSeconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - wallStart).count();
+    report.virtualSeconds = static_cast<double>(clock.now() - start);
+    report.remindersFired = lateness.size();
+    report.dueAtEnd = manager.getDueCount();
+
+    if (report.wallSeconds > 0.0) {
+        report.speedup = report.virtualSeconds / report.wallSeconds;
+        report.firingRate = report.remindersFired / report.wallSeconds;
+    }
+    if (lateness.empty()) return true;
+
+    double total = 0.0;
+    for (double value : lateness) total += value;
+    report.avgLateness = total / lateness.size();
+
+    size_t p99 = std::min(lateness.size() - 1, lateness.size() * 99 / 100);
+    std::nth_element(lateness.begin(), lateness.begin() + p99, lateness.end());
+    report.p99Lateness = lateness[p99];
+    report.maxLateness = *std::max_element(lateness.begin(), lateness.end());
+    return true;
+}
+
+void Simulator::printReport(const SimulationReport& report) {
+    std::cout << "\n=== SIMULATION REPORT ===" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Events loaded:      " << report.eventsLoaded << std::endl;
+    std::cout << "Reminders fired:    " << report.remindersFired << std::endl;
+    std::cout << "Due after run:      " << report.dueAtEnd << std::endl;
+    std::cout << "Virtual time:       " << report.virtualSeconds << " s" << std::endl;
+    std::cout << "Wall time:          " << report.wallSeconds << " s" << std::endl;
+    std::cout << "Speedup:            " << report.speedup << "x" << std::endl;
+    std::cout << "Firing rate:        " << report.firingRate << " reminders/s" << std::endl;
+    std::cout << "Lateness avg/p99/max: " << report.avgLateness << " / "
+              << report.p99Lateness << " / " << report.maxLateness << " virtual s" << std::endl;
+    if (report.maxWallLagMs > 0.0) {
+        std::cout << "Max wall-clock lag: " << report.maxWallLagMs << " ms" << std::endl;
+    }
+    std::cout << "Query                   calls    avg ms    max ms" << std::endl;
+    const std::pair<const char*, const QueryTiming*> queries[] = {
+        {"getDueCount", &report.dueCount},
+        {"getDueReminders", &report.dueReminders},
+        {"getUpcomingReminders", &report.upcomingReminders},
+    };
+    for (const auto& query : queries) {
+        const QueryTiming& timing = *query.second;
+        std::cout << std::left << std::setw(22) << query.first << std::right << std::setw(8) << timing.calls
+                  << std::setprecision(3) << std::setw(10) << (timing.calls > 0 ? timing.totalMs / timing.calls : 0.0)
+                  << std::setw(10) << timing.maxMs << std::endl;
+    }
+}
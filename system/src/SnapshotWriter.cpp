@@ -0,0 +1,95 @@
+#include "../include/SnapshotWriter.h"
+#include <iostream>
+
+SnapshotWriter::SnapshotWriter()
+    : busy(false), stopping(false), flushing(0), commitDelay(0), worker(&SnapshotWriter::run, this) {}
+
+SnapshotWriter::~SnapshotWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    worker.join();
+    for (const auto& entry : failed) {
+        std::cerr << "Error: Changes to " << entry.first << " were not saved" << std::endl;
+    }
+}
+
+void SnapshotWriter::submit(const FileHandler& target, const PersistentEventMap& snapshot) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = pending.find(target.getFilename());
+        if (it != pending.end()) {
+            it->second = std::make_pair(target, snapshot);
+        } else {
+            pending.emplace(target.getFilename(), std::make_pair(target, snapshot));
+        }
+        failed.erase(target.getFilename()); // Superseded
+        stats.submitted++;
+    }
+    wake.notify_one();
+}
+
+bool SnapshotWriter::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    pending.insert(failed.begin(), failed.end()); // Retry failed writes
+    failed.clear();
+    flushing++;
+    wake.notify_one(); // End a commit delay in progress
+    idle.wait(lock, [this] { return pending.empty() && !busy; });
+    flushing--;
+    return failed.empty();
+}
+
+void SnapshotWriter::setCommitDelay(std::chrono::milliseconds delay) {
+    std::lock_guard<std::mutex> lock(mutex);
+    commitDelay = delay;
+}
+
+std::chrono::milliseconds SnapshotWriter::getCommitDelay() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return commitDelay;
+}
+
+CommitStats SnapshotWriter::getStats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+void SnapshotWriter::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this] { return stopping || !pending.empty(); });
+        if (pending.empty()) return; // Stopping with nothing left to write
+
+        // Let further changes join this commit; submit() replaces the pending snapshot
+        if (commitDelay.count() > 0) {
+            wake.wait_for(lock, commitDelay, [this] { return stopping || flushing > 0; });
+        }
+
+        std::string path = pending.begin()->first;
+        FileHandler target = pending.begin()->second.first;
+        PersistentEventMap snapshot = pending.begin()->second.second;
+        pending.erase(pending.begin());
+        busy = true;
+
+        // Snapshots are immutable, so the file is written without holding the lock
+        lock.unlock();
+        auto started = std::chrono::steady_clock::now();
+        bool saved = target.saveSnapshot(snapshot);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        lock.lock();
+
+        stats.commits++;
+        if (!saved) {
+            stats.failures++;
+            // Keep it for flush() to retry unless a newer snapshot is already waiting
+            if (pending.find(path) == pending.end()) failed.emplace(path, std::make_pair(target, snapshot));
+        }
+        stats.totalSeconds += seconds;
+        if (seconds > stats.maxSeconds) stats.maxSeconds = seconds;
+        busy = false;
+        if (pending.empty()) idle.notify_all();
+    }
+}
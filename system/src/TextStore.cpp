@@ -0,0 +1,204 @@
+#include "../include/TextStore.h"
+#include <stdexcept>
+#include <iostream>
+
+namespace {
+
+// Strings this short live inside the string object; spilling them frees nothing
+const size_t INLINE_TEXT = 15;
+
+size_t heapBytes(size_t length) {
+    return length > INLINE_TEXT ? length : 0;
+}
+
+bool seekTo(std::FILE* file, uint64_t offset) {
+#ifdef _WIN32
+    return _fseeki64(file, static_cast<__int64>(offset), SEEK_SET) == 0;
+#else
+    return fseeko(file, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+}
+
+} // namespace
+
+EventText::EventText(std::string title, std::string description, bool tracked)
+    : title(std::move(title)), description(std::move(description)), tracked(tracked), spilled(false),
+      titleLength(static_cast<uint32_t>(this->title.size())),
+      descriptionLength(static_cast<uint32_t>(this->description.size())), slot(NO_SLOT), slotSize(0),
+      newer(nullptr), older(nullptr) {}
+
+EventText::~EventText() {
+    if (tracked) TextStore::instance().release(*this);
+}
+
+TextStore::TextStore()
+    : file(nullptr), limit(0), spillTitles(false), fileEnd(0), newest(nullptr), oldest(nullptr) {}
+
+TextStore& TextStore::instance() {
+    // Never destroyed: event text may still be released while the program exits
+    static TextStore* store = new TextStore();
+    return *store;
+}
+
+bool TextStore::enable(const std::string& path, size_t limitBytes, bool spillTitles) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (file) {
+        std::cerr << "Error: The memory limit is already set" << std::endl;
+        return false;
+    }
+#ifdef _WIN32
+    file = std::fopen(path.c_str(), "w+bD"); // Deleted when closed
+#else
+    file = std::fopen(path.c_str(), "w+b");
+    if (file) std::remove(path.c_str()); // Stays usable until closed, and can't be left behind
+#endif
+    if (!file) {
+        std::cerr << "Error: Could not create spill file " << path << std::endl;
+        return false;
+    }
+    this->path = path;
+    this->spillTitles = spillTitles;
+    limit.store(limitBytes > 0 ? limitBytes : 1, std::memory_order_release);
+    return true;
+}
+
+void TextStore::setLimit(size_t limitBytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!file || limitBytes == 0) return;
+    limit = limitBytes;
+    evictOverLimit(nullptr);
+}
+
+TextStoreStats TextStore::getStats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    TextStoreStats current = stats;
+    current.limit = limit.load();
+    current.spillFileBytes = fileEnd;
+    return current;
+}
+
+size_t TextStore::spillableBytes(const EventText& text) const {
+    return heapBytes(text.descriptionLength) + (spillTitles ? heapBytes(text.titleLength) : 0);
+}
+
+std::shared_ptr<EventText> TextStore::make(std::string title, std::string description) {
+    if (limit.load(std::memory_order_acquire) == 0) {
+        return std::make_shared<EventText>(std::move(title), std::move(description), false);
+    }
+    // Text with nothing to spill isn't worth tracking
+    size_t bytes = heapBytes(description.size()) + (spillTitles ? heapBytes(title.size()) : 0);
+    std::shared_ptr<EventText> text =
+        std::make_shared<EventText>(std::move(title), std::move(description), bytes > 0);
+    if (bytes > 0) {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++stats.texts;
+        link(*text);
+        evictOverLimit(text.get());
+    }
+    return text;
+}
+
+const std::string& TextStore::title(EventText& text, std::string& copy) {
+    // Without spilled titles a title never moves, so it can be read in place
+    if (!text.tracked || !spillTitles) return text.title;
+    std::lock_guard<std::mutex> lock(mutex);
+    if (text.spilled) fault(text);
+    touch(text);
+    copy = text.title;
+    evictOverLimit(&text);
+    return copy;
+}
+
+const std::string& TextStore::description(EventText& text, std::string& copy) {
+    if (!text.tracked) return text.description;
+    std::lock_guard<std::mutex> lock(mutex);
+    if (text.spilled) fault(text);
+    touch(text);
+    copy = text.description;
+    evictOverLimit(&text);
+    return copy;
+}
+
+void TextStore::release(EventText& text) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (text.spilled) {
+        --stats.spilled;
+    } else {
+        unlink(text);
+    }
+    if (text.slot != EventText::NO_SLOT) freeSlots.emplace(text.slotSize, text.slot);
+    --stats.texts;
+}
+
+void TextStore::link(EventText& text) {
+    text.older = newest;
+    text.newer = nullptr;
+    if (newest) newest->newer = &text;
+    newest = &text;
+    if (!oldest) oldest = &text;
+    stats.residentBytes += spillableBytes(text);
+}
+
+void TextStore::unlink(EventText& text) {
+    (text.newer ? text.newer->older : newest) = text.older;
+    (text.older ? text.older->newer : oldest) = text.newer;
+    text.newer = text.older = nullptr;
+    stats.residentBytes -= spillableBytes(text);
+}
+
+void TextStore::touch(EventText& text) {
+    if (newest == &text) return;
+    unlink(text);
+    link(text);
+}
+
+bool TextStore::spill(EventText& text) {
+    // Text never changes, so once written it can be dropped again for free
+    if (text.slot == EventText::NO_SLOT) {
+        uint32_t size = text.descriptionLength + (spillTitles ? text.titleLength : 0);
+        auto reuse = freeSlots.lower_bound(size);
+        uint64_t offset = reuse != freeSlots.end() ? reuse->second : fileEnd;
+        if (!seekTo(file, offset) ||
+            (spillTitles && std::fwrite(text.title.data(), 1, text.titleLength, file) != text.titleLength) ||
+            std::fwrite(text.description.data(), 1, text.descriptionLength, file) != text.descriptionLength) {
+            std::cerr << "Error: Could not write to spill file " << path << std::endl;
+            return false;
+        }
+        if (reuse != freeSlots.end()) {
+            text.slotSize = reuse->first;
+            freeSlots.erase(reuse);
+        } else {
+            text.slotSize = size;
+            fileEnd += size;
+        }
+        text.slot = offset;
+    }
+    unlink(text);
+    if (spillTitles) std::string().swap(text.title);
+    std::string().swap(text.description);
+    text.spilled = true;
+    ++stats.spilled;
+    return true;
+}
+
+void TextStore::fault(EventText& text) {
+    std::string title(spillTitles ? text.titleLength : 0, '\0');
+    std::string description(text.descriptionLength, '\0');
+    // Nothing sensible can be shown or saved without the text, so this is fatal
+    if (!seekTo(file, text.slot) || std::fread(&title[0], 1, title.size(), file) != title.size() ||
+        std::fread(&description[0], 1, description.size(), file) != description.size()) {
+        throw std::runtime_error("could not read event text back from spill file " + path);
+    }
+    if (spillTitles) text.title = std::move(title);
+    text.description = std::move(description);
+    text.spilled = false;
+    --stats.spilled;
+    ++stats.faults;
+    link(text);
+}
+
+void TextStore::evictOverLimit(const EventText* keep) {
+    while (stats.residentBytes > limit && oldest && oldest != keep) {
+        if (!spill(*oldest)) break;
+    }
+}
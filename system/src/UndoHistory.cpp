@@ -0,0 +1,34 @@
+#include "../include/UndoHistory.h"
+
+UndoHistory::UndoHistory(size_t limit) : limit(limit > 0 ? limit : 1) {}
+
+void UndoHistory::record(const PersistentEventMap& before) {
+    if (undoStack.size() == limit) {
+        undoStack.erase(undoStack.begin());
+    }
+    undoStack.push_back(before);
+    redoStack.clear();
+}
+
+bool UndoHistory::undo(EventManager& manager) {
+    if (undoStack.empty()) return false;
+
+    redoStack.push_back(manager.snapshot());
+    manager.restore(undoStack.back());
+    undoStack.pop_back();
+    return true;
+}
+
+bool UndoHistory::redo(EventManager& manager) {
+    if (redoStack.empty()) return false;
+
+    undoStack.push_back(manager.snapshot());
+    manager.restore(redoStack.back());
+    redoStack.pop_back();
+    return true;
+}
+
+void UndoHistory::clear() {
+    undoStack.clear();
+    redoStack.clear();
+}
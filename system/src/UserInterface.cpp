@@ -1,22 +1,76 @@
 #include "../include/UserInterface.h"
+#include "../include/Interchange.h"
+#include "../include/Reports.h"
+#include "../include/TextStore.h"
 #include <iostream>
 #include <iomanip>
 #include <sstream>
 #include <limits>
+#include <algorithm>
+#include <cctype>
 
-UserInterface::UserInterface() : fileHandler("events.dat") {
-    fileHandler.loadEvents(eventManager);
+const int UserInterface::DEFAULT_COMMIT_DELAY_MS;
+const int UserInterface::CALENDAR_IDLE_SECONDS;
+
+UserInterface::UserInterface(bool shared) : calendars("events.dat"), active(nullptr), outsideChanges(false) {
+    writer.setCommitDelay(std::chrono::milliseconds(DEFAULT_COMMIT_DELAY_MS));
+    calendars.setShared(shared);
+    
+    // Only the default calendar is loaded up front; others on first use
+    openCalendar(CalendarRegistry::DEFAULT_NAME);
+    saveChanges();
+}
+
+void UserInterface::openCalendar(const std::string& name) {
+    bool opened = false;
+    active = &calendars.open(name, std::time(nullptr), opened);
+    if (opened) {
+        size_t archived = archiveOldEvents();
+        if (archived > 0) {
+            std::cout << "Archived " << archived << " completed or past event(s)." << std::endl;
+        }
+    }
+}
+
+size_t UserInterface::archiveOldEvents() {
+    return active->archive.archive(active->events, archivePolicy);
+}
+
+void UserInterface::saveChanges() {
+    // O(1) snapshots; the files are written on the writer thread
+    for (Calendar* calendar : calendars.getLoaded()) {
+        if (calendar->shared) {
+            // Undo would restore a version without the others' changes
+            if (calendar->shared->sync() > 0) {
+                calendar->history.clear();
+                outsideChanges = true;
+            }
+        } else if (calendar->unsaved) {
+            writer.submit(calendar->file, calendar->events.snapshot());
+            calendar->unsaved = false;
+        }
+    }
+}
+
+void UserInterface::compactShared(Calendar& calendar) {
+    if (calendar.shared->compact()) {
+        calendar.unsaved = false;
+    } else {
+        std::cout << "Failed to save " << calendar.file.getFilename() << "." << std::endl;
+    }
 }
 
 void UserInterface::clearScreen() {
 #ifdef _WIN32
     system("cls");
 #else
-    system("clear");
+    // ANSI clear + home; avoids spawning a shell for every menu
+    std::cout << "\033[2J\033[H" << std::flush;
 #endif
 }
 
 void UserInterface::pauseScreen() {
+    saveChanges(); // Never leave edits unsaved while waiting on the user
     std::cout << "\nPress Enter to continue...";
     std::cin.ignore();
     std::cin.get();
@@ -34,9 +88,15 @@ void UserInterface::displayMenu() {
     std::cout << "║  6. Mark Event as Completed          ║" << std::endl;
     std::cout << "║  7. View Reminders                   ║" << std::endl;
     std::cout << "║  8. Settings & Backup                ║" << std::endl;
+    std::cout << "║  9. Undo Last Change                 ║" << std::endl;
+    std::cout << "║ 10. Redo                             ║" << std::endl;
+    std::cout << "║ 11. Calendars                        ║" << std::endl;
     std::cout << "║  0. Exit                             ║" << std::endl;
     std::cout << "╚══════════════════════════════════════╝" << std::endl;
-    std::cout << "Total Events: " << eventManager.getEventCount() << std::endl;
+    EventStats stats = active->events.getStats();
+    std::cout << "Calendar: " << active->name << std::endl;
+    std::cout << "Total Events: " << stats.total << " (" << stats.pending << " pending, "
+              << stats.due << " due, " << stats.completed << " completed)" << std::endl;
 }
 
 std::string UserInterface::getStringInput(const std::string& prompt) {
@@ -84,6 +144,58 @@ int UserInterface::getPriorityInput() {
     return priority;
 }
 
+std::time_t UserInterface::getDurationInput() {
+    int minutes = getIntInput("Duration in minutes (0 for none): ");
+    return minutes > 0 ? static_cast<std::time_t>(minutes) * 60 : 0;
+}
+
+void UserInterface::warnConflicts(const Event& event, int excludeId) {
+    std::vector<Event> conflicts = active->events.findConflicts(event, excludeId);
+    if (conflicts.empty()) return;
+    
+    EventRenderer renderer(RenderFormat::Compact, active->events.getClock().now());
+    renderer.line("\n⚠ Warning: this overlaps " + std::to_string(conflicts.size()) + " pending event(s):");
+    renderer.beginTable();
+    for (const Event& conflict : conflicts) {
+        renderer.add(conflict);
+    }
+    renderer.flush();
+}
+
+RecurrenceRule UserInterface::getRecurrenceInput() {
+    RecurrenceRule rule;
+    std::cout << "Repeat (0=No, 1=Daily, 2=Weekly, 3=Monthly, 4=Every N hours): ";
+    int choice;
+    std::cin >> choice;
+    
+    switch (choice) {
+        case 1: rule.type = RecurrenceType::Daily; break;
+        case 2: rule.type = RecurrenceType::Weekly; break;
+        case 3: rule.type = RecurrenceType::Monthly; break;
+        case 4: rule.type = RecurrenceType::Interval; break;
+        default: return rule;
+    }
+    
+    if (rule.type == RecurrenceType::Interval) {
+        int hours = getIntInput("Repeat every how many hours? ");
+        rule.every = 3600L * (hours > 0 ? hours : 1);
+    } else {
+        int every = getIntInput("Repeat every N periods (1 = every one): ");
+        rule.every = every > 0 ? every : 1;
+    }
+    
+    int count = getIntInput("Number of occurrences (0 = no limit): ");
+    rule.count = count > 0 ? count : 0;
+    
+    std::cout << "Set an end date? (y/n): ";
+    char setEnd;
+    std::cin >> setEnd;
+    if (setEnd == 'y' || setEnd == 'Y') {
+        rule.until = getDateTimeInput();
+    }
+    return rule;
+}
+
 void UserInterface::handleAddEvent() {
     clearScreen();
     std::cout << "=== ADD NEW EVENT ===" << std::endl;
@@ -91,16 +203,66 @@ void UserInterface::handleAddEvent() {
     std::string title = getStringInput("Event Title: ");
     std::string description = getStringInput("Event Description: ");
     std::time_t eventTime = getDateTimeInput();
+    std::time_t duration = getDurationInput();
     int priority = getPriorityInput();
+    RecurrenceRule recurrence = getRecurrenceInput();
     
     Event newEvent(title, description, eventTime, priority);
-    eventManager.addEvent(newEvent);
+    newEvent.setDuration(duration);
+    newEvent.setRecurrence(recurrence);
+    warnConflicts(newEvent, 0);
+    active->events.addEvent(newEvent);
     
     std::cout << "\nEvent added successfully!" << std::endl;
-    fileHandler.saveEvents(eventManager);
     pauseScreen();
 }
 
+RenderFormat UserInterface::getFormatInput() {
+    int choice = getIntInput("Format (1=Detailed, 2=Compact table): ");
+    return choice == 2 ? RenderFormat::Compact : RenderFormat::Detailed;
+}
+
+void UserInterface::showPaged(const std::string& heading, const EventFilter& filter, RenderFormat format) {
+    const size_t pageSize = (format == RenderFormat::Compact) ? 40 : 10;
+    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    
+    EventRenderer renderer(format, active->events.getClock().now());
+    EventCursor cursor;
+    int pageNumber = 0;
+    size_t shown = 0;
+    
+    while (true) {
+        std::vector<const Event*> page = active->events.nextPage(cursor, pageSize, filter);
+        ++pageNumber;
+        shown += page.size();
+        
+        renderer.line("\n" + heading + " - Page " + std::to_string(pageNumber));
+        renderer.beginTable();
+        for (const Event* event : page) {
+            renderer.add(*event);
+        }
+        if (shown == 0) {
+            renderer.line("No matching events.");
+        }
+        
+        if (cursor.atEnd()) {
+            renderer.line("(" + std::to_string(shown) + " event(s) shown) Press Enter to continue...");
+            renderer.flush();
+            std::string input;
+            std::getline(std::cin, input);
+            return;
+        }
+        
+        renderer.line("-- Enter: next page, q: back to menu --");
+        renderer.flush();
+        std::string input;
+        if (!std::getline(std::cin, input) || input == "q" || input == "Q") {
+            return;
+        }
+        clearScreen();
+    }
+}
+
 void UserInterface::handleViewEvents() {
     clearScreen();
     std::cout << "=== VIEW EVENTS ===" << std::endl;
@@ -108,29 +270,111 @@ void UserInterface::handleViewEvents() {
     std::cout << "2. Upcoming Events" << std::endl;
     std::cout << "3. Due Events" << std::endl;
     std::cout << "4. Events by Priority" << std::endl;
+    std::cout << "5. Events in Date Range" << std::endl;
+    std::cout << "6. What's Next (by urgency)" << std::endl;
+    std::cout << "7. Find Free Time" << std::endl;
+    std::cout << "8. Reports" << std::endl;
     
     int choice = getIntInput("Choose option: ");
+    std::time_t now = active->events.getClock().now();
     
     switch (choice) {
         case 1:
-            eventManager.displayAllEvents();
+            showPaged("=== ALL EVENTS ===", EventFilter(), getFormatInput());
             break;
         case 2:
-            eventManager.displayUpcomingEvents();
+            showPaged("=== UPCOMING EVENTS ===",
+                      [now](const Event& event) { return event.isUpcoming(now); },
+                      getFormatInput());
             break;
         case 3:
-            eventManager.displayDueEvents();
+            showPaged("=== DUE EVENTS ===",
+                      [now](const Event& event) { return event.isDue(now); },
+                      getFormatInput());
             break;
         case 4: {
             int priority = getPriorityInput();
-            eventManager.displayEventsByPriority(priority);
+            showPaged("=== EVENTS BY PRIORITY ===",
+                      [priority](const Event& event) { return event.getPriority() == priority; },
+                      getFormatInput());
+            break;
+        }
+        case 5: {
+            std::cout << "From - ";
+            std::time_t from = getDateTimeInput();
+            std::cout << "To - ";
+            std::time_t to = getDateTimeInput();
+            
+            std::vector<Event> events = active->events.getEventsInRange(from, to);
+            EventRenderer renderer(getFormatInput(), now);
+            renderer.line("\n=== EVENTS IN RANGE (" + std::to_string(events.size()) + ") ===");
+            for (const Event& event : events) {
+                renderer.add(event);
+            }
+            renderer.flush();
+            pauseScreen();
+            break;
+        }
+        case 6: {
+            int count = getIntInput("How many tasks? ");
+            std::vector<Event> tasks = active->events.nextTasks(count > 0 ? count : 10);
+            EventRenderer renderer(RenderFormat::Compact, now);
+            renderer.line("\n=== WHAT'S NEXT ===");
+            renderer.beginTable();
+            for (const Event& event : tasks) {
+                renderer.add(event);
+            }
+            if (tasks.empty()) {
+                renderer.line("Nothing pending.");
+            }
+            renderer.flush();
+            pauseScreen();
+            break;
+        }
+        case 7: {
+            int days = getIntInput("Search how many days ahead? ");
+            int minutes = getIntInput("Minimum free time in minutes: ");
+            WorkingHours hours;
+            std::cout << "Only during working hours (09:00-17:00, Mon-Fri)? (y/n): ";
+            char working;
+            std::cin >> working;
+            hours.enabled = hours.weekdaysOnly = (working == 'y' || working == 'Y');
+            
+            std::vector<TimeSlot> slots = active->events.findFreeSlots(
+                now, now + static_cast<std::time_t>(days > 0 ? days : 1) * 86400,
+                static_cast<std::time_t>(minutes > 0 ? minutes : 1) * 60, 10, hours);
+            
+            std::cout << "\n=== FREE TIME ===" << std::endl;
+            for (const TimeSlot& slot : slots) {
+                char start[20], end[20];
+                std::strftime(start, sizeof(start), "%Y-%m-%d %H:%M", std::localtime(&slot.start));
+                std::strftime(end, sizeof(end), "%Y-%m-%d %H:%M", std::localtime(&slot.end));
+                std::cout << start << " - " << end << std::endl;
+            }
+            if (slots.empty()) {
+                std::cout << "No free time found." << std::endl;
+            }
+            pauseScreen();
+            break;
+        }
+        case 8: {
+            PersistentEventMap events = active->events.snapshot();
+            std::string out = "\n=== REPORTS ===\n";
+            Reports::render(Reports::build(events, now), out);
+            std::cout << out;
+
+            std::string path = getStringInput("\nWrite the event columns to a file (Enter to skip): ");
+            size_t bytes = 0;
+            if (!path.empty() && Reports::exportColumns(path, events, bytes)) {
+                std::cout << "Wrote " << events.size() << " row(s), " << bytes << " bytes." << std::endl;
+            }
+            pauseScreen();
             break;
         }
         default:
             std::cout << "Invalid option." << std::endl;
+            pauseScreen();
     }
-    
-    pauseScreen();
 }
 
 void UserInterface::handleSearchEvents() {
@@ -138,15 +382,16 @@ void UserInterface::handleSearchEvents() {
     std::cout << "=== SEARCH EVENTS ===" << std::endl;
     
     std::string searchTerm = getStringInput("Enter search term (title): ");
-    std::vector<Event> results = eventManager.searchByTitle(searchTerm);
+    std::vector<CalendarEvent> results = calendars.query(
+        [&searchTerm](const EventManager& manager) { return manager.searchByTitle(searchTerm); });
     
     if (results.empty()) {
         std::cout << "No events found matching '" << searchTerm << "'" << std::endl;
     } else {
-        std::cout << "Found " << results.size() << " event(s):" << std::endl;
-        for (const Event& event : results) {
-            event.display();
-        }
+        EventRenderer renderer(RenderFormat::Detailed, active->events.getClock().now());
+        renderer.line("Found " + std::to_string(results.size()) + " event(s):");
+        addMerged(renderer, results);
+        renderer.flush();
     }
     
     pauseScreen();
@@ -157,45 +402,52 @@ void UserInterface::handleUpdateEvent() {
     std::cout << "=== UPDATE EVENT ===" << std::endl;
     
     int id = getIntInput("Enter Event ID to update: ");
-    Event* event = eventManager.findEvent(id);
+    EventHandle handle = active->events.findEvent(id);
+    const Event* found = active->events.getEvent(handle);
     
-    if (event == nullptr) {
+    if (found == nullptr) {
         std::cout << "Event not found." << std::endl;
         pauseScreen();
         return;
     }
     
+    // Work on a copy; the handle checks the event is still there at the end
+    const Event event = *found;
     std::cout << "Current event details:" << std::endl;
-    event->display();
+    event.display(active->events.getClock().now());
     
-    std::string title = getStringInput("New Title (or press Enter to keep current): ");
-    if (title.empty()) title = event->getTitle();
+    // Only the fields asked for change; the event keeps its ID and status
+    EventPatch patch;
+    patch.title = getStringInput("New Title (or press Enter to keep current): ");
+    patch.hasTitle = !patch.title.empty();
     
-    std::string description = getStringInput("New Description (or press Enter to keep current): ");
-    if (description.empty()) description = event->getDescription();
+    patch.description = getStringInput("New Description (or press Enter to keep current): ");
+    patch.hasDescription = !patch.description.empty();
     
     std::cout << "Update date/time? (y/n): ";
     char updateTime;
     std::cin >> updateTime;
     
-    std::time_t eventTime = event->getEventTime();
     if (updateTime == 'y' || updateTime == 'Y') {
-        eventTime = getDateTimeInput();
+        patch.hasTime = patch.hasDuration = true;
+        patch.eventTime = getDateTimeInput();
+        patch.duration = getDurationInput();
     }
     
     std::cout << "Update priority? (y/n): ";
     char updatePriority;
     std::cin >> updatePriority;
     
-    int priority = event->getPriority();
     if (updatePriority == 'y' || updatePriority == 'Y') {
-        priority = getPriorityInput();
+        patch.hasPriority = true;
+        patch.priority = getPriorityInput();
     }
     
-    Event updatedEvent(title, description, eventTime, priority);
-    if (eventManager.updateEvent(id, updatedEvent)) {
+    Event updatedEvent = event;
+    patch.applyTo(updatedEvent);
+    warnConflicts(updatedEvent, id);
+    if (active->events.patchEvent(handle, patch)) {
         std::cout << "Event updated successfully!" << std::endl;
-        fileHandler.saveEvents(eventManager);
     } else {
         std::cout << "Failed to update event." << std::endl;
     }
@@ -208,7 +460,8 @@ void UserInterface::handleDeleteEvent() {
     std::cout << "=== DELETE EVENT ===" << std::endl;
     
     int id = getIntInput("Enter Event ID to delete: ");
-    Event* event = eventManager.findEvent(id);
+    EventHandle handle = active->events.findEvent(id);
+    const Event* event = active->events.getEvent(handle);
     
     if (event == nullptr) {
         std::cout << "Event not found." << std::endl;
@@ -217,16 +470,15 @@ void UserInterface::handleDeleteEvent() {
     }
     
     std::cout << "Event to delete:" << std::endl;
-    event->display();
+    event->display(active->events.getClock().now());
     
     std::cout << "Are you sure you want to delete this event? (y/n): ";
     char confirm;
     std::cin >> confirm;
     
     if (confirm == 'y' || confirm == 'Y') {
-        if (eventManager.removeEvent(id)) {
+        if (active->events.removeEvent(handle)) {
             std::cout << "Event deleted successfully!" << std::endl;
-            fileHandler.saveEvents(eventManager);
         } else {
             std::cout << "Failed to delete event." << std::endl;
         }
@@ -242,7 +494,8 @@ void UserInterface::handleMarkCompleted() {
     std::cout << "=== MARK EVENT AS COMPLETED ===" << std::endl;
     
     int id = getIntInput("Enter Event ID to mark as completed: ");
-    Event* event = eventManager.findEvent(id);
+    EventHandle handle = active->events.findEvent(id);
+    const Event* event = active->events.getEvent(handle);
     
     if (event == nullptr) {
         std::cout << "Event not found." << std::endl;
@@ -253,9 +506,13 @@ void UserInterface::handleMarkCompleted() {
     if (event->getIsCompleted()) {
         std::cout << "Event is already marked as completed." << std::endl;
     } else {
-        eventManager.markEventCompleted(id);
-        std::cout << "Event marked as completed!" << std::endl;
-        fileHandler.saveEvents(eventManager);
+        active->events.markEventCompleted(handle);
+        event = active->events.getEvent(handle);
+        if (event->getIsCompleted()) {
+            std::cout << "Event marked as completed!" << std::endl;
+        } else {
+            std::cout << "Occurrence completed. Next occurrence: " << event->getFormattedTime() << std::endl;
+        }
     }
     
     pauseScreen();
@@ -264,24 +521,24 @@ void UserInterface::handleMarkCompleted() {
 void UserInterface::handleReminders() {
     clearScreen();
     std::cout << "=== REMINDERS ===" << std::endl;
+    EventRenderer renderer(RenderFormat::Detailed, active->events.getClock().now());
     
-    // Show due events
-    std::vector<Event> dueEvents = eventManager.getDueReminders();
+    // Show due events, from every loaded calendar
+    std::vector<CalendarEvent> dueEvents = calendars.query(
+        [](const EventManager& manager) { return manager.getDueReminders(); });
     if (!dueEvents.empty()) {
-        std::cout << "\n🚨 DUE EVENTS (" << dueEvents.size() << "):" << std::endl;
-        for (const Event& event : dueEvents) {
-            event.display();
-        }
+        renderer.line("\n🚨 DUE EVENTS (" + std::to_string(dueEvents.size()) + "):");
+        addMerged(renderer, dueEvents);
     }
     
     // Show upcoming events (next 24 hours)
-    std::vector<Event> upcomingEvents = eventManager.getUpcomingReminders(24);
+    std::vector<CalendarEvent> upcomingEvents = calendars.query(
+        [](const EventManager& manager) { return manager.getUpcomingReminders(24); });
     if (!upcomingEvents.empty()) {
-        std::cout << "\n⏰ UPCOMING EVENTS (Next 24 hours) (" << upcomingEvents.size() << "):" << std::endl;
-        for (const Event& event : upcomingEvents) {
-            event.display();
-        }
+        renderer.line("\n⏰ UPCOMING EVENTS (Next 24 hours) (" + std::to_string(upcomingEvents.size()) + "):");
+        addMerged(renderer, upcomingEvents);
     }
+    renderer.flush();
     
     if (dueEvents.empty() && upcomingEvents.empty()) {
         std::cout << "No immediate reminders." << std::endl;
@@ -297,36 +554,280 @@ void UserInterface::handleSettings() {
     std::cout << "2. Restore from Backup" << std::endl;
     std::cout << "3. Save Current Data" << std::endl;
     std::cout << "4. Reload Data from File" << std::endl;
+    std::cout << "5. Archive" << std::endl;
+    std::cout << "6. Priority Aging (currently " << active->events.getAgingHorizon() / 3600
+              << " hour(s) per level)" << std::endl;
+    std::cout << "7. Compressed Storage (currently " << (active->file.isCompressed() ? "on" : "off")
+              << ")" << std::endl;
+    std::cout << "8. Save Batching (currently " << writer.getCommitDelay().count() << " ms, "
+              << (active->file.getSyncWrites() ? "synced" : "not synced") << ")" << std::endl;
+    std::cout << "9. Import Events (.ics or .csv)" << std::endl;
+    std::cout << "10. Export Events (.ics or .csv)" << std::endl;
+    TextStoreStats text = TextStore::instance().getStats();
+    std::cout << "11. Memory Limit (currently ";
+    if (text.limit > 0) {
+        std::cout << (text.limit >> 20) << " MB, " << (text.residentBytes >> 10) << " KB of text in memory)"
+                  << std::endl;
+    } else {
+        std::cout << "off)" << std::endl;
+    }
     
     int choice = getIntInput("Choose option: ");
     
     switch (choice) {
-        case 1:
-            if (fileHandler.createBackup()) {
-                std::cout << "Backup created successfully!" << std::endl;
+        case 1: {
+            // The backup reads the data file, so it must be up to date
+            saveChanges();
+            writer.flush();
+            if (active->shared) compactShared(*active);
+            int generation = active->file.createBackup();
+            if (generation > 0) {
+                std::cout << "Backup generation " << generation << " created successfully!" << std::endl;
             } else {
                 std::cout << "Failed to create backup." << std::endl;
             }
             break;
-        case 2:
-            if (fileHandler.restoreFromBackup()) {
+        }
+        case 2: {
+            writer.flush(); // A pending save must not overwrite the restored file
+            BackupStore backups(active->file.getFilename());
+            const std::vector<BackupGeneration>& generations = backups.list();
+            size_t shown = generations.size() < 10 ? generations.size() : 10;
+            for (size_t i = generations.size() - shown; i < generations.size(); ++i) {
+                const BackupGeneration& generation = generations[i];
+                std::cout << std::setw(4) << generation.id << "  "
+                          << std::put_time(std::localtime(&generation.createdAt), "%Y-%m-%d %H:%M:%S")
+                          << "  " << generation.size << " bytes" << std::endl;
+            }
+            int generation = shown > 0 ? getIntInput("Generation to restore (0 = latest): ") : 0;
+            if (active->file.restoreFromBackup(generation)) {
                 std::cout << "Backup restored successfully! Reloading data..." << std::endl;
-                fileHandler.loadEvents(eventManager);
+                if (active->shared) active->shared->reset(); // Changes since then are gone for everyone
+                active->events.clear();
+                calendars.load(*active);
             } else {
                 std::cout << "Failed to restore backup." << std::endl;
             }
             break;
+        }
         case 3:
-            if (fileHandler.saveEvents(eventManager)) {
+            // A failed background save is retried by the flush, so it must succeed too
+            if (writer.flush() &&
+                (active->shared ? active->shared->compact() : active->file.saveEvents(active->events))) {
+                active->unsaved = false;
                 std::cout << "Data saved successfully!" << std::endl;
             } else {
                 std::cout << "Failed to save data." << std::endl;
             }
             break;
         case 4:
-            fileHandler.loadEvents(eventManager);
+            writer.flush();
+            active->events.clear();
+            calendars.load(*active);
             std::cout << "Data reloaded from file." << std::endl;
             break;
+        case 5:
+            handleArchive();
+            return;
+        case 6: {
+            // Each priority level below High counts as this much later a deadline
+            int hours = getIntInput("Hours of deadline per priority level: ");
+            active->events.setAgingHorizon(static_cast<std::time_t>(hours > 0 ? hours : 0) * 3600);
+            std::cout << "Priority aging updated." << std::endl;
+            break;
+        }
+        case 7:
+            active->file.setCompressed(!active->file.isCompressed());
+            active->unsaved = true; // Rewrite the file in the new layout
+            std::cout << "Compressed storage " << (active->file.isCompressed() ? "enabled." : "disabled.")
+                      << std::endl;
+            break;
+        case 8: {
+            CommitStats stats = writer.getStats();
+            std::cout << stats.submitted << " change(s) saved in " << stats.commits << " write(s), "
+                      << std::fixed << std::setprecision(1)
+                      << (stats.commits > 0 ? stats.totalSeconds * 1000 / stats.commits : 0.0)
+                      << " ms average, " << stats.maxSeconds * 1000 << " ms longest";
+            if (stats.failures > 0) std::cout << ", " << stats.failures << " failed";
+            std::cout << std::endl;
+            std::cout.unsetf(std::ios::floatfield);
+            
+            // Changes within the delay share one write; longer means fewer disk flushes
+            // but more recent changes lost if the program is killed
+            int delay = getIntInput("Milliseconds to gather changes before saving: ");
+            writer.setCommitDelay(std::chrono::milliseconds(delay > 0 ? delay : 0));
+            int sync = getIntInput("Wait for each save to reach the disk? (1 = yes, 0 = no): ");
+            calendars.setSyncWrites(sync != 0);
+            std::cout << "Save batching updated." << std::endl;
+            break;
+        }
+        case 9:
+        case 10: {
+            bool import = choice == 9;
+            std::string path = getStringInput(import ? "File to import: " : "File to export to: ");
+            InterchangeFormat format;
+            if (!Interchange::formatFor(path, format)) {
+                std::cout << "Expected a .ics or .csv file." << std::endl;
+                break;
+            }
+            InterchangeStats stats;
+            bool done = import ? Interchange::importFile(path, format, active->events, stats)
+                               : Interchange::exportFile(path, format, active->events, stats);
+            if (!done) {
+                std::cout << (import ? "Import failed." : "Export failed.") << std::endl;
+                break;
+            }
+            std::cout << (import ? "Imported " : "Exported ") << stats.events << " event(s)";
+            if (stats.skipped > 0) std::cout << ", skipped " << stats.skipped;
+            std::cout << "." << std::endl;
+            if (import && stats.events > 0) active->unsaved = true;
+            break;
+        }
+        case 11: {
+            // Set at startup, so that every event loaded counts against it
+            if (text.limit == 0) {
+                std::cout << "Start the program with --memory-limit MB to keep event text under a limit."
+                          << std::endl;
+                break;
+            }
+            std::cout << text.spilled << " of " << text.texts << " event text(s) in the spill file ("
+                      << (text.spillFileBytes >> 10) << " KB), " << text.faults << " read back" << std::endl;
+            int megabytes = getIntInput("New limit in MB (0 = keep): ");
+            if (megabytes > 0) {
+                TextStore::instance().setLimit(static_cast<size_t>(megabytes) << 20);
+                std::cout << "Memory limit updated." << std::endl;
+            }
+            break;
+        }
+        default:
+            std::cout << "Invalid option." << std::endl;
+    }
+    
+    pauseScreen();
+}
+
+void UserInterface::addMerged(EventRenderer& renderer, const std::vector<CalendarEvent>& events) {
+    bool label = calendars.getLoaded().size() > 1; // Say where each event is from
+    for (const CalendarEvent& entry : events) {
+        if (label) renderer.line("[" + entry.calendar->name + "]");
+        renderer.add(entry.event);
+    }
+}
+
+void UserInterface::handleCalendars() {
+    clearScreen();
+    std::cout << "=== CALENDARS ===" << std::endl;
+    
+    std::vector<std::string> names = calendars.names();
+    std::vector<Calendar*> loaded = calendars.getLoaded();
+    for (size_t i = 0; i < names.size(); ++i) {
+        std::cout << std::setw(3) << i + 1 << ". " << names[i];
+        for (const Calendar* calendar : loaded) {
+            if (calendar->name == names[i]) {
+                std::cout << " - " << calendar->events.getEventCount() << " event(s)"
+                          << (calendar == active ? ", current" : ", loaded");
+            }
+        }
+        std::cout << std::endl;
+    }
+    
+    std::string input = getStringInput("\nCalendar to open, by number or name (a new name creates one, Enter to stay): ");
+    if (input.empty()) return;
+    std::string name = input;
+    bool number = input.size() < 6 &&
+                  std::all_of(input.begin(), input.end(), [](char c) { return std::isdigit(static_cast<unsigned char>(c)); });
+    if (number) {
+        size_t position = std::stoul(input);
+        if (position >= 1 && position <= names.size()) name = names[position - 1];
+    }
+    if (!CalendarRegistry::isValidName(name)) {
+        std::cout << "Calendar names use letters, digits, '-' and '_' (up to 32)." << std::endl;
+    } else {
+        openCalendar(name);
+        std::cout << "Switched to calendar " << active->name << " (" << active->events.getEventCount()
+                  << " event(s))." << std::endl;
+    }
+    std::cout << "\nPress Enter to continue...";
+    std::cin.get();
+}
+
+void UserInterface::handleUndoRedo(bool redo) {
+    bool done = redo ? active->history.redo(active->events) : active->history.undo(active->events);
+    if (done) {
+        std::cout << (redo ? "Change redone." : "Last change undone.") << std::endl;
+    } else {
+        std::cout << (redo ? "Nothing to redo." : "Nothing to undo.") << std::endl;
+    }
+    pauseScreen();
+}
+
+void UserInterface::handleArchive() {
+    clearScreen();
+    std::cout << "=== ARCHIVE ===" << std::endl;
+    
+    ArchiveStats stats;
+    if (active->archive.getStats(stats)) {
+        std::cout << stats.events << " archived event(s) in " << stats.frames << " frame(s), "
+                  << stats.storedBytes << " bytes on disk (" << stats.rawBytes << " uncompressed)" << std::endl;
+    }
+    std::cout << "Policy: archive completed events " << (archivePolicy.archiveCompleted ? "yes" : "no")
+              << ", pending events older than ";
+    if (archivePolicy.maxAgeDays > 0) {
+        std::cout << archivePolicy.maxAgeDays << " day(s)" << std::endl;
+    } else {
+        std::cout << "never" << std::endl;
+    }
+    
+    std::cout << "\n1. Archive Now" << std::endl;
+    std::cout << "2. Search Archive" << std::endl;
+    std::cout << "3. List Archive" << std::endl;
+    std::cout << "4. Set Archive Age" << std::endl;
+    std::cout << "5. Toggle Archiving of Completed Events" << std::endl;
+    
+    int choice = getIntInput("Choose option: ");
+    
+    switch (choice) {
+        case 1: {
+            size_t archived = archiveOldEvents();
+            if (archived > 0) {
+                active->history.clear(); // The archive is append-only, so this can't be undone
+                outsideChanges = true;   // Nor recorded as a step when the menu returns
+            }
+            std::cout << "Archived " << archived << " event(s)." << std::endl;
+            break;
+        }
+        case 2:
+        case 3: {
+            std::vector<Event> results;
+            if (choice == 2) {
+                results = active->archive.searchByTitle(getStringInput("Enter search term (title): "));
+            } else {
+                active->archive.forEach([&results](const Event& event) {
+                    results.push_back(event);
+                    return true;
+                });
+            }
+            
+            EventRenderer renderer(RenderFormat::Compact, active->events.getClock().now());
+            renderer.line("Found " + std::to_string(results.size()) + " archived event(s):");
+            renderer.beginTable();
+            for (const Event& event : results) {
+                renderer.add(event);
+            }
+            renderer.flush();
+            break;
+        }
+        case 4: {
+            int days = getIntInput("Archive pending events older than how many days (0 = never): ");
+            archivePolicy.maxAgeDays = days > 0 ? days : 0;
+            std::cout << "Archive age updated." << std::endl;
+            break;
+        }
+        case 5:
+            archivePolicy.archiveCompleted = !archivePolicy.archiveCompleted;
+            std::cout << "Completed events will " << (archivePolicy.archiveCompleted ? "" : "not ")
+                      << "be archived." << std::endl;
+            break;
         default:
             std::cout << "Invalid option." << std::endl;
     }
@@ -353,15 +854,26 @@ void UserInterface::showWelcome() {
     std::cout << "╚══════════════════════════════════════════════════════════╝" << std::endl;
     
     // Show immediate reminders
-    std::vector<Event> dueEvents = eventManager.getDueReminders();
-    if (!dueEvents.empty()) {
-        std::cout << "\n🚨 You have " << dueEvents.size() << " due event(s)!" << std::endl;
+    int dueCount = active->events.getDueCount();
+    if (dueCount > 0) {
+        std::cout << "\n🚨 You have " << dueCount << " due event(s)!" << std::endl;
+    }
+    
+    std::vector<Event> nextEvents = active->events.nextEvents(5);
+    if (!nextEvents.empty()) {
+        EventRenderer renderer(RenderFormat::Compact, active->events.getClock().now());
+        renderer.line("\nComing up next:");
+        renderer.beginTable();
+        for (const Event& event : nextEvents) {
+            renderer.add(event);
+        }
+        renderer.flush();
     }
     
     pauseScreen();
 }
 
-void UserInterface::showGoodbye() {
+void UserInterface::showGoodbye(bool saved) {
     clearScreen();
     std::cout << "╔══════════════════════════════════════════════════════════╗" << std::endl;
     std::cout << "║                                                          ║" << std::endl;
@@ -369,7 +881,11 @@ void UserInterface::showGoodbye() {
     std::cout << "║                                                          ║" << std::endl;
     std::cout << "║         Thank you for using Event Reminder System       ║" << std::endl;
     std::cout << "║                                                          ║" << std::endl;
-    std::cout << "║              Your data has been saved.                  ║" << std::endl;
+    if (saved) {
+        std::cout << "║              Your data has been saved.                  ║" << std::endl;
+    } else {
+        std::cout << "║         Some changes were NOT saved.                    ║" << std::endl;
+    }
     std::cout << "║                                                          ║" << std::endl;
     std::cout << "╚══════════════════════════════════════════════════════════╝" << std::endl;
 }
@@ -383,6 +899,17 @@ void UserInterface::run() {
         displayMenu();
         choice = getIntInput("\nEnter your choice: ");
         
+        // Calendars left alone for a while give their memory back
+        std::time_t now = std::time(nullptr);
+        active->lastUsed = now;
+        calendars.evictIdle(now, CALENDAR_IDLE_SECONDS, active, writer);
+        saveChanges(); // Shared calendars catch up before the action
+        outsideChanges = false;
+        
+        // Undo belongs to the calendar the action started in
+        Calendar* current = active;
+        PersistentEventMap before = current->events.snapshot();
+        
         switch (choice) {
             case 1: handleAddEvent(); break;
             case 2: handleViewEvents(); break;
@@ -392,13 +919,35 @@ void UserInterface::run() {
             case 6: handleMarkCompleted(); break;
             case 7: handleReminders(); break;
             case 8: handleSettings(); break;
+            case 9: handleUndoRedo(false); break;
+            case 10: handleUndoRedo(true); break;
+            case 11: handleCalendars(); break;
             case 0: 
-                fileHandler.saveEvents(eventManager);
-                showGoodbye();
+                saveChanges();
+                for (Calendar* calendar : calendars.getLoaded()) {
+                    // Leaves the data file complete for instances that don't share
+                    if (calendar->shared && calendar->unsaved) compactShared(*calendar);
+                }
+                if (!writer.flush()) {
+                    std::cout << "\nSome changes could not be saved. Exit anyway? (y/n): ";
+                    char confirm;
+                    std::cin >> confirm;
+                    if (confirm != 'y' && confirm != 'Y') {
+                        choice = -1; // Back to the menu; the next save retries them
+                        break;
+                    }
+                    showGoodbye(false);
+                    break;
+                }
+                showGoodbye(true);
                 break;
             default:
                 std::cout << "Invalid choice. Please try again." << std::endl;
                 pauseScreen();
         }
+        if (choice != 9 && choice != 10 && !outsideChanges && !before.sameAs(current->events.snapshot())) {
+            current->history.record(before);
+        }
+        saveChanges(); // Handlers that return without pausing
     } while (choice != 0);
 }
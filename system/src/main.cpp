@@ -1,22 +1,491 @@
 #include "../include/UserInterface.h"
+#include "../include/Simulator.h"
+#include "../include/BatchProcessor.h"
+#include "../include/EventServer.h"
+#include "../include/LoadGenerator.h"
+#include "../include/ArchiveStore.h"
+#include "../include/BackupStore.h"
+#include "../include/Interchange.h"
+#include "../include/Reports.h"
+#include "../include/TextStore.h"
 #include <iostream>
 #include <exception>
+#include <string>
+#include <cstdlib>
+#include <fstream>
+#include <ctime>
+#include <chrono>
+
+namespace {
+
+void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " [mode]" << std::endl;
+    std::cout << "  (no arguments)            Interactive menu" << std::endl;
+    std::cout << "  --shared                  Interactive menu, alongside other --shared instances (Linux)" << std::endl;
+    std::cout << "  --batch [FILE|-] [options] Run commands from FILE or stdin without the menu" << std::endl;
+    std::cout << "      --data PATH           Data file (default events.dat)" << std::endl;
+    std::cout << "      --checkpoint N        Save after every N changes (default: only at end)" << std::endl;
+    std::cout << "      --no-save             Do not write the data file" << std::endl;
+    std::cout << "      --compress            Save in the block-compressed layout" << std::endl;
+    std::cout << "      --no-sync             Do not wait for saves to reach the disk" << std::endl;
+    std::cout << "      --shared              Work alongside other --shared instances on the same data" << std::endl;
+    std::cout << "  --serve [options]         Share one event store over a local socket (Linux)" << std::endl;
+    std::cout << "      --socket PATH         Socket path (default " << Protocol::DEFAULT_SOCKET << ")" << std::endl;
+    std::cout << "      --data PATH           Data file (default events.dat)" << std::endl;
+    std::cout << "      --save-interval SECS  Persist changes at most this often (default 5)" << std::endl;
+    std::cout << "      --no-sync             Do not wait for saves to reach the disk" << std::endl;
+    std::cout << "  --loadgen [options]       Benchmark a running server (Linux)" << std::endl;
+    std::cout << "      --socket PATH         Socket path" << std::endl;
+    std::cout << "      --connections N       Concurrent connections (default 4)" << std::endl;
+    std::cout << "      --requests N          Requests per connection (default 50000)" << std::endl;
+    std::cout << "      --pipeline N          Requests in flight per connection (default 16)" << std::endl;
+    std::cout << "      --writes PERCENT      Share of add/remove requests (default 20)" << std::endl;
+    std::cout << "  --simulate [options]      Replay events through virtual time" << std::endl;
+    std::cout << "      --events N            Synthetic event count (default 100000)" << std::endl;
+    std::cout << "      --file PATH           Replay a data file instead" << std::endl;
+    std::cout << "      --span SECONDS        Virtual period covered by synthetic events" << std::endl;
+    std::cout << "      --tick SECONDS        Virtual seconds per dispatcher step (default 1)" << std::endl;
+    std::cout << "      --upcoming HOURS      Window of the upcoming query on each step (default 1)" << std::endl;
+    std::cout << "      --speed X             Pace at X times real time (0 = unthrottled)" << std::endl;
+    std::cout << "      --seed N              Random seed for synthetic events" << std::endl;
+    std::cout << "  --archive [options]       Move completed and past events into the archive" << std::endl;
+    std::cout << "      --data PATH           Data file (default events.dat)" << std::endl;
+    std::cout << "      --days N              Archive pending events older than N days (default 30, 0 = never)" << std::endl;
+    std::cout << "      --keep-completed      Leave completed events in the data file" << std::endl;
+    std::cout << "  --backup [options]        Back up the data file as a new generation" << std::endl;
+    std::cout << "      --data PATH           Data file (default events.dat)" << std::endl;
+    std::cout << "      --list                List generations instead" << std::endl;
+    std::cout << "      --restore GEN         Restore generation GEN (0 = latest) instead" << std::endl;
+    std::cout << "  --import FILE [--data PATH]  Add the events in an .ics or .csv file" << std::endl;
+    std::cout << "  --export FILE [--data PATH]  Write all events to an .ics or .csv file" << std::endl;
+    std::cout << "  --report [options]        Events per day, completion by priority, overdue by week" << std::endl;
+    std::cout << "      --data PATH           Data file (default events.dat)" << std::endl;
+    std::cout << "      --columns FILE        Also write the event columns for analysis tools" << std::endl;
+    std::cout << "  --recover [--data PATH]   Back up a damaged data file and rewrite it with the readable events" << std::endl;
+    std::cout << "  --help                    Show this help" << std::endl;
+    std::cout << "With any mode:" << std::endl;
+    std::cout << "  --memory-limit MB         Keep at most MB of event descriptions in memory and" << std::endl;
+    std::cout << "                            spill the least recently used to a file next to the data" << std::endl;
+    std::cout << "      --spill-titles        Count and spill titles too (searches may read the disk)" << std::endl;
+}
+
+int runBatch(int argc, char* argv[]) {
+    BatchConfig config;
+    std::string source = "-";
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--no-save") {
+            config.save = false;
+        } else if (arg == "--compress") {
+            config.compress = true;
+        } else if (arg == "--no-sync") {
+            config.sync = false;
+        } else if (arg == "--shared") {
+            config.shared = true;
+        } else if (arg == "--data" || arg == "--checkpoint") {
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << arg << std::endl;
+                return 1;
+            }
+            std::string value = argv[++i];
+            if (arg == "--data") config.dataFile = value;
+            else config.checkpointEvery = std::stoul(value);
+        } else if (arg.compare(0, 2, "--") == 0) {
+            std::cerr << "Unknown batch option: " << arg << std::endl;
+            return 1;
+        } else {
+            source = arg;
+        }
+    }
+    if (config.shared && !config.save) {
+        std::cerr << "--shared publishes every change, so it can't be combined with --no-save" << std::endl;
+        return 1;
+    }
+
+    std::ios::sync_with_stdio(false);
+    EventManager manager;
+    BatchProcessor processor(manager, config);
+    if (!processor.loadData()) return 1;
+
+    if (source == "-") {
+        return processor.run(std::cin) ? 0 : 2;
+    }
+
+    std::ifstream input(source);
+    if (!input.is_open()) {
+        std::cerr << "Error: Could not open command file: " << source << std::endl;
+        return 1;
+    }
+    return processor.run(input) ? 0 : 2;
+}
+
+int runServer(int argc, char* argv[]) {
+    ServerConfig config;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--no-sync") {
+            config.syncWrites = false;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << std::endl;
+            return 1;
+        }
+        std::string value = argv[++i];
+        if (arg == "--socket") config.socketPath = value;
+        else if (arg == "--data") config.dataFile = value;
+        else if (arg == "--save-interval") config.saveIntervalSeconds = std::stoi(value);
+        else {
+            std::cerr << "Unknown server option: " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    EventManager manager;
+    EventServer server(manager, config);
+    if (!server.loadData()) return 1;
+    return server.run() ? 0 : 1;
+}
+
+int runLoadGenerator(int argc, char* argv[]) {
+    LoadConfig config;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << std::endl;
+            return 1;
+        }
+        std::string value = argv[++i];
+        if (arg == "--socket") config.socketPath = value;
+        else if (arg == "--connections") config.connections = std::stoi(value);
+        else if (arg == "--requests") config.requestsPerConnection = std::stoul(value);
+        else if (arg == "--pipeline") config.pipelineDepth = std::stoul(value);
+        else if (arg == "--writes") config.writePercent = std::stoi(value);
+        else {
+            std::cerr << "Unknown load generator option: " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    LoadGenerator generator(config);
+    return generator.run() ? 0 : 1;
+}
+
+int runSimulation(int argc, char* argv[]) {
+    SimulationConfig config;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << std::endl;
+            return 1;
+        }
+        std::string value = argv[++i];
+        if (arg == "--events") config.eventCount = std::stoul(value);
+        else if (arg == "--file") config.dataFile = value;
+        else if (arg == "--span") config.span = std::stoll(value);
+        else if (arg == "--tick") config.tick = std::stoll(value);
+        else if (arg == "--upcoming") config.upcomingHours = std::stoi(value);
+        else if (arg == "--speed") config.speed = std::stod(value);
+        else if (arg == "--seed") config.seed = static_cast<unsigned>(std::stoul(value));
+        else {
+            std::cerr << "Unknown simulation option: " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    Simulator simulator(config);
+    SimulationReport report;
+    if (!simulator.run(report)) return 1;
+    Simulator::printReport(report);
+    return 0;
+}
+
+// Migrates an existing data file: cold events go to <data>.archive and the
+// data file is rewritten with only the active ones
+int runArchive(int argc, char* argv[]) {
+    std::string dataFile = "events.dat";
+    ArchivePolicy policy;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--keep-completed") {
+            policy.archiveCompleted = false;
+        } else if (arg == "--data" || arg == "--days") {
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << arg << std::endl;
+                return 1;
+            }
+            std::string value = argv[++i];
+            if (arg == "--data") dataFile = value;
+            else policy.maxAgeDays = std::stoi(value);
+        } else {
+            std::cerr << "Unknown archive option: " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    EventManager manager;
+    FileHandler fileHandler(dataFile);
+    ArchiveStore archive(ArchiveStore::forDataFile(dataFile));
+    archive.reserveIds();
+    if (!fileHandler.loadEvents(manager)) return 1;
+
+    size_t archived = archive.archive(manager, policy);
+    if (archived > 0 && !fileHandler.saveEvents(manager)) return 1;
+
+    ArchiveStats stats;
+    archive.getStats(stats);
+    std::cout << "Archived " << archived << " event(s); " << manager.getEventCount()
+              << " active event(s) remain in " << dataFile << std::endl;
+    std::cout << archive.getFilename() << ": " << stats.events << " event(s), "
+              << stats.storedBytes << " of " << stats.rawBytes << " bytes after compression" << std::endl;
+    return 0;
+}
+
+int runBackup(int argc, char* argv[]) {
+    std::string dataFile = "events.dat";
+    bool list = false;
+    int restore = -1;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--list") {
+            list = true;
+        } else if (arg == "--data" || arg == "--restore") {
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << arg << std::endl;
+                return 1;
+            }
+            std::string value = argv[++i];
+            if (arg == "--data") dataFile = value;
+            else restore = std::stoi(value);
+        } else {
+            std::cerr << "Unknown backup option: " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    BackupStore backups(dataFile);
+    if (list) {
+        for (const BackupGeneration& generation : backups.list()) {
+            std::cout << generation.id << "\t" << generation.createdAt << "\t" << generation.size
+                      << " bytes\t" << generation.chunks.size() << " chunk(s)\t"
+                      << generation.newBytes << " new" << std::endl;
+        }
+        std::cout << backups.getPackBytes() << " byte(s) stored" << std::endl;
+        return 0;
+    }
+    if (restore >= 0) {
+        if (!backups.restore(restore)) return 1;
+        std::cout << "Restored " << dataFile << std::endl;
+        return 0;
+    }
+
+    int generation = backups.create(std::time(nullptr));
+    if (generation == 0) return 1;
+    std::cout << "Backup generation " << generation << ": " << backups.list().back().newBytes
+              << " new byte(s), " << backups.getPackBytes() << " stored in total" << std::endl;
+    return 0;
+}
+
+// --import and --export: the format follows the file extension
+int runInterchange(int argc, char* argv[], bool import) {
+    std::string dataFile = "events.dat";
+    std::string path;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--data" && i + 1 < argc) {
+            dataFile = argv[++i];
+        } else if (path.empty() && arg.compare(0, 2, "--") != 0) {
+            path = arg;
+        } else {
+            std::cerr << "Unknown " << (import ? "import" : "export") << " option: " << arg << std::endl;
+            return 1;
+        }
+    }
+    InterchangeFormat format;
+    if (path.empty() || !Interchange::formatFor(path, format)) {
+        std::cerr << "Error: Expected a .ics or .csv file" << std::endl;
+        return 1;
+    }
+
+    EventManager manager;
+    FileHandler fileHandler(dataFile);
+    ArchiveStore(ArchiveStore::forDataFile(dataFile)).reserveIds();
+    if (!fileHandler.loadEvents(manager)) return 1;
+
+    InterchangeStats stats;
+    auto started = std::chrono::steady_clock::now();
+    bool done = import ? Interchange::importFile(path, format, manager, stats)
+                       : Interchange::exportFile(path, format, manager, stats);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    if (!done) return 1;
+
+    std::cout << (import ? "Imported " : "Exported ") << stats.events << " event(s)";
+    if (stats.skipped > 0) std::cout << ", skipped " << stats.skipped << " cancelled, without a usable start time or malformed";
+    std::cout << " (" << stats.bytes << " bytes in " << seconds << " s)" << std::endl;
+    if (import && stats.events > 0 && !fileHandler.saveEvents(manager)) return 1;
+    return 0;
+}
+
+int runReport(int argc, char* argv[]) {
+    std::string dataFile = "events.dat";
+    std::string columnsFile;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--data" && i + 1 < argc) {
+            dataFile = argv[++i];
+        } else if (arg == "--columns" && i + 1 < argc) {
+            columnsFile = argv[++i];
+        } else {
+            std::cerr << "Unknown report option: " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    EventManager manager;
+    FileHandler fileHandler(dataFile);
+    if (!fileHandler.loadEvents(manager)) return 1;
+    PersistentEventMap events = manager.snapshot();
+
+    auto started = std::chrono::steady_clock::now();
+    EventReport report = Reports::build(events, manager.getClock().now());
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    std::string out;
+    Reports::render(report, out, report.perDay.size() + report.overdueByWeek.size());
+    std::cout << out << "(built in " << seconds * 1000 << " ms)" << std::endl;
+
+    if (!columnsFile.empty()) {
+        size_t bytes = 0;
+        started = std::chrono::steady_clock::now();
+        if (!Reports::exportColumns(columnsFile, events, bytes)) return 1;
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        std::cout << "Wrote " << events.size() << " row(s) to " << columnsFile << " (" << bytes
+                  << " bytes in " << seconds * 1000 << " ms)" << std::endl;
+    }
+    return 0;
+}
+
+int runRecover(int argc, char* argv[]) {
+    std::string dataFile = "events.dat";
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--data" && i + 1 < argc) {
+            dataFile = argv[++i];
+        } else {
+            std::cerr << "Unknown recover option: " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    EventManager manager;
+    FileHandler fileHandler(dataFile);
+    if (!fileHandler.fileExists()) {
+        std::cerr << "Error: No data file: " << dataFile << std::endl;
+        return 1;
+    }
+    if (!fileHandler.recoverEvents(manager)) return 1;
+    if (fileHandler.getLoadReport().damage.empty()) {
+        std::cout << dataFile << " is intact." << std::endl;
+        return 0;
+    }
+    if (fileHandler.getLoadReport().loaded == 0) {
+        std::cerr << "Nothing readable in " << dataFile << "; left it unchanged." << std::endl;
+        return 1;
+    }
+    return fileHandler.saveEvents(manager) ? 0 : 1;
+}
+
+// Takes the options that apply to every mode out of argv
+bool applyMemoryLimit(int& argc, char* argv[]) {
+    std::string dataFile = "events.dat";
+    long megabytes = 0;
+    bool spillTitles = false;
+    int kept = 1;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--memory-limit") {
+            megabytes = i + 1 < argc ? std::atol(argv[++i]) : 0;
+            if (megabytes <= 0) {
+                std::cerr << "Error: --memory-limit needs a size in MB" << std::endl;
+                return false;
+            }
+            continue;
+        }
+        if (arg == "--spill-titles") {
+            spillTitles = true;
+            continue;
+        }
+        if (arg == "--data" && i + 1 < argc) dataFile = argv[i + 1];
+        argv[kept++] = argv[i];
+    }
+    argc = kept;
+    argv[argc] = nullptr;
+    if (megabytes == 0) {
+        if (spillTitles) std::cerr << "Warning: --spill-titles has no effect without --memory-limit" << std::endl;
+        return true;
+    }
+    // Before anything is loaded, so that every event counts against the limit
+    return TextStore::instance().enable(dataFile + ".spill", static_cast<size_t>(megabytes) << 20, spillTitles);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (!applyMemoryLimit(argc, argv)) return 1;
+    std::string mode = argc > 1 ? argv[1] : "";
 
-int main() {
     try {
-        UserInterface ui;
+        if (mode == "--batch") {
+            return runBatch(argc, argv);
+        }
+        if (mode == "--serve") {
+            return runServer(argc, argv);
+        }
+        if (mode == "--loadgen") {
+            return runLoadGenerator(argc, argv);
+        }
+        if (mode == "--simulate") {
+            return runSimulation(argc, argv);
+        }
+        if (mode == "--archive") {
+            return runArchive(argc, argv);
+        }
+        if (mode == "--backup") {
+            return runBackup(argc, argv);
+        }
+        if (mode == "--import" || mode == "--export") {
+            return runInterchange(argc, argv, mode == "--import");
+        }
+        if (mode == "--report") {
+            return runReport(argc, argv);
+        }
+        if (mode == "--recover") {
+            return runRecover(argc, argv);
+        }
+        if (mode == "--help" || mode == "-h") {
+            printUsage(argv[0]);
+            return 0;
+        }
+        if (!mode.empty() && mode != "--shared") {
+            std::cerr << "Unknown option: " << mode << std::endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+
+        UserInterface ui(mode == "--shared");
         ui.run();
     } catch (const std::exception& e) {
         std::cerr << "Fatal error: " << e.what() << std::endl;
+        if (!mode.empty()) return 1;
         std::cerr << "Press Enter to exit...";
         std::cin.get();
         return 1;
     } catch (...) {
         std::cerr << "Unknown fatal error occurred." << std::endl;
+        if (!mode.empty()) return 1;
         std::cerr << "Press Enter to exit...";
         std::cin.get();
         return 1;
     }
-    
+
     return 0;
 }
@@ -0,0 +1,210 @@
+// Round-trip and corruption checks for the on-disk formats: run with `make check`.
+// Each check prints one line; the exit status is the number of failures.
+#include "../include/Checksum.h"
+#include "../include/Compression.h"
+#include "../include/EventManager.h"
+#include "../include/FileHandler.h"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+void check(bool passed, const std::string& name) {
+    std::cout << (passed ? "PASS  " : "FAIL  ") << name << std::endl;
+    if (!passed) ++failures;
+}
+
+// Keeps FileHandler's progress messages out of the check output
+class Quiet {
+private:
+    std::ostringstream sink;
+    std::streambuf* out;
+    std::streambuf* err;
+
+public:
+    Quiet() : out(std::cout.rdbuf(sink.rdbuf())), err(std::cerr.rdbuf(sink.rdbuf())) {}
+    ~Quiet() {
+        std::cout.rdbuf(out);
+        std::cerr.rdbuf(err);
+    }
+};
+
+// Events by ID in their serialized form, for comparing two stores
+std::map<int, std::string> contents(const EventManager& manager) {
+    std::map<int, std::string> events;
+    for (const Event& event : manager.getAllEvents()) {
+        events[event.getId()] = event.serialize();
+    }
+    return events;
+}
+
+// Enough varied events to fill several compressed blocks
+void fillSample(EventManager& manager, size_t count) {
+    std::mt19937 rng(7);
+    std::vector<Event> events;
+    for (size_t i = 0; i < count; ++i) {
+        Event event("Event " + std::to_string(i) + (i % 7 == 0 ? " | with a bar \\ and slash" : ""),
+                    std::string(rng() % 200, static_cast<char>('a' + i % 26)),
+                    1800000000 + static_cast<std::time_t>(rng() % 10000000), 1 + static_cast<int>(i % 3));
+        if (i % 5 == 0) event.setDuration(1800);
+        if (i % 11 == 0) {
+            RecurrenceRule rule;
+            RecurrenceRule::parse("weekly:1:10", rule);
+            event.setRecurrence(rule);
+        }
+        if (i % 4 == 0) event.setCompleted(true);
+        events.push_back(event);
+    }
+    manager.addEvents(events);
+}
+
+std::string readAll(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+void writeAll(const std::string& path, const std::string& data) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(data.data(), static_cast<std::streamsize>(data.size()));
+}
+
+void checkCrc() {
+    check(Checksum::crc32c("123456789", 9) == 0xE3069283u, "crc32c(\"123456789\") == 0xE3069283");
+    check(Checksum::crc32c("6789", 4, Checksum::crc32c("12345", 5)) == 0xE3069283u,
+          "crc32c continues over split input");
+}
+
+void checkCompression() {
+    std::string data;
+    std::mt19937 rng(1);
+    for (int i = 0; i < 20000; ++i) {
+        data += (i % 3 == 0) ? std::to_string(rng()) : "repeated event text ";
+    }
+    std::string packed;
+    Compression::compress(data.data(), data.size(), packed);
+    std::string unpacked;
+    bool ok = Compression::decompress(packed.data(), packed.size(), data.size(), unpacked);
+    check(ok && unpacked == data && packed.size() < data.size(), "compression round trip");
+
+    unpacked.clear();
+    check(!Compression::decompress(packed.data(), packed.size() / 2, data.size(), unpacked),
+          "compression rejects truncated input");
+}
+
+void checkRoundTrip(const std::string& path, bool compressed) {
+    const char* layout = compressed ? "compressed" : "plain";
+    EventManager original;
+    fillSample(original, 5000);
+
+    FileHandler writer(path);
+    writer.setCompressed(compressed);
+    writer.setSyncWrites(false);
+    EventManager loaded;
+    FileHandler reader(path);
+    bool saved, read;
+    {
+        Quiet quiet;
+        saved = writer.saveEvents(original);
+        read = reader.loadEvents(loaded);
+    }
+    check(reader.isCompressed() == compressed, std::string(layout) + " layout detected on load");
+    check(saved && read && contents(loaded) == contents(original), std::string(layout) + " save/load round trip");
+}
+
+void checkRecovery(const std::string& path, bool compressed) {
+    const char* layout = compressed ? "compressed" : "plain";
+    EventManager original;
+    fillSample(original, 5000);
+    std::map<int, std::string> expected = contents(original);
+
+    FileHandler writer(path);
+    writer.setCompressed(compressed);
+    writer.setSyncWrites(false);
+    std::string data;
+    {
+        Quiet quiet;
+        writer.saveEvents(original);
+        data = readAll(path);
+    }
+    writeAll(path, data.substr(0, data.size() * 3 / 5)); // Cut off mid-record
+
+    EventManager strict;
+    EventManager recovered;
+    bool rejected, recoveredOk;
+    LoadReport report;
+    {
+        Quiet quiet;
+        FileHandler reader(path);
+        reader.setSyncWrites(false);
+        rejected = !reader.loadEvents(strict);
+        recoveredOk = reader.recoverEvents(recovered);
+        report = reader.getLoadReport();
+    }
+    check(rejected, std::string(layout) + " truncated file fails a normal load");
+
+    // Whatever was recovered must match the original exactly
+    std::map<int, std::string> events = contents(recovered);
+    bool matching = !events.empty() && events.size() < expected.size();
+    for (const auto& entry : events) {
+        auto it = expected.find(entry.first);
+        matching = matching && it != expected.end() && it->second == entry.second;
+    }
+    check(recoveredOk && !report.damage.empty() && matching,
+          std::string(layout) + " truncated file recovers " + std::to_string(events.size()) + " of " +
+          std::to_string(expected.size()) + " events intact");
+}
+
+void checkCorruptRecord(const std::string& path) {
+    EventManager original;
+    fillSample(original, 1000);
+
+    FileHandler writer(path);
+    writer.setSyncWrites(false);
+    std::string data;
+    {
+        Quiet quiet;
+        writer.saveEvents(original);
+        data = readAll(path);
+    }
+    data[data.size() / 2] ^= 0x5A; // One flipped byte inside a record
+    writeAll(path, data);
+
+    EventManager recovered;
+    bool ok;
+    {
+        Quiet quiet;
+        FileHandler reader(path);
+        reader.setSyncWrites(false);
+        ok = reader.recoverEvents(recovered);
+    }
+    check(ok && recovered.getEventCount() == original.getEventCount() - 1,
+          "flipped byte loses exactly one record to the checksum");
+}
+
+} // namespace
+
+int main() {
+    namespace fs = std::filesystem;
+    fs::path directory = fs::temp_directory_path() / ("event_reminder_check_" + std::to_string(std::random_device()()));
+    fs::create_directories(directory);
+
+    checkCrc();
+    checkCompression();
+    checkRoundTrip((directory / "plain.dat").string(), false);
+    checkRoundTrip((directory / "compressed.dat").string(), true);
+    checkRecovery((directory / "plain_cut.dat").string(), false);
+    checkRecovery((directory / "compressed_cut.dat").string(), true);
+    checkCorruptRecord((directory / "flipped.dat").string());
+
+    fs::remove_all(directory);
+    std::cout << (failures == 0 ? "All checks passed." : std::to_string(failures) + " check(s) failed.") << std::endl;
+    return failures;
+}